@@ -9,55 +9,85 @@ CMD_SRCS += \
 C_SRCS += \
 ../clock.c \
 ../gpio.c \
-../i2c0.c \
+../i2c.c \
+../i2cslave.c \
+../itm.c \
+../latency.c \
 ../main.c \
 ../nvic.c \
+../swi2c.c \
 ../tm4c123gh6pm_startup_ccs.c \
+../uart0.c \
 ../wait.c 
 
 C_DEPS += \
 ./clock.d \
 ./gpio.d \
-./i2c0.d \
+./i2c.d \
+./i2cslave.d \
+./itm.d \
+./latency.d \
 ./main.d \
 ./nvic.d \
+./swi2c.d \
 ./tm4c123gh6pm_startup_ccs.d \
+./uart0.d \
 ./wait.d 
 
 OBJS += \
 ./clock.obj \
 ./gpio.obj \
-./i2c0.obj \
+./i2c.obj \
+./i2cslave.obj \
+./itm.obj \
+./latency.obj \
 ./main.obj \
 ./nvic.obj \
+./swi2c.obj \
 ./tm4c123gh6pm_startup_ccs.obj \
+./uart0.obj \
 ./wait.obj 
 
 OBJS__QUOTED += \
 "clock.obj" \
 "gpio.obj" \
-"i2c0.obj" \
+"i2c.obj" \
+"i2cslave.obj" \
+"itm.obj" \
+"latency.obj" \
 "main.obj" \
 "nvic.obj" \
+"swi2c.obj" \
 "tm4c123gh6pm_startup_ccs.obj" \
+"uart0.obj" \
 "wait.obj" 
 
 C_DEPS__QUOTED += \
 "clock.d" \
 "gpio.d" \
-"i2c0.d" \
+"i2c.d" \
+"i2cslave.d" \
+"itm.d" \
+"latency.d" \
 "main.d" \
 "nvic.d" \
+"swi2c.d" \
 "tm4c123gh6pm_startup_ccs.d" \
+"uart0.d" \
 "wait.d" 
 
 C_SRCS__QUOTED += \
 "../clock.c" \
 "../gpio.c" \
-"../i2c0.c" \
+"../i2c.c" \
+"../i2cslave.c" \
+"../itm.c" \
+"../latency.c" \
 "../main.c" \
 "../nvic.c" \
+"../swi2c.c" \
 "../tm4c123gh6pm_startup_ccs.c" \
+"../uart0.c" \
 "../wait.c" 
 
 
@@ -0,0 +1,40 @@
+// DWT Cycle Counter
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Debug and trace registers not covered by tm4c123gh6pm.h
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef DWT_H_
+#define DWT_H_
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+
+#define DEMCR_TRCENA        0x01000000      // NVIC_DBG_INT_R trace enable
+#define DWT_CTRL_R          (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R        (*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA  0x00000001
+
+// Start the free running cycle counter, safe to call more than once
+static inline void initCycleCounter(void)
+{
+    if (!(DWT_CTRL_R & DWT_CTRL_CYCCNTENA))
+    {
+        NVIC_DBG_INT_R |= DEMCR_TRCENA;
+        DWT_CYCCNT_R = 0;
+        DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+    }
+}
+
+#endif
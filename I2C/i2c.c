@@ -0,0 +1,857 @@
+// I2C Library
+// Jason Losh
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// I2C0: SCL PB2, SDA PB3
+// I2C1: SCL PA6, SDA PA7
+// I2C2: SCL PE4, SDA PE5
+// I2C3: SCL PD0, SDA PD1
+// 2kohm pullups on SDA and SCL of every bus in use
+
+// Each module runs its own queue of transactions from its master interrupt,
+// one byte per interrupt, so the four buses progress in parallel and the CPU
+// is free between bytes. The blocking register functions queue a transaction
+// and wait for it, so they interleave safely with queued work on the same bus.
+// Blocking calls must not be made from priorities at or above PRIORITY_BUS.
+//
+// Every failure ends the transaction with a status instead of a hang:
+// NACK and arbitration loss come from MCS, a device stretching SCL past the
+// clock-low limit raises the clock timeout interrupt, and a transaction that
+// makes no progress within its deadline is aborted from the TIMER1A interrupt,
+// so queued work times out without a caller polling checkI2cTimeout(). The
+// last two clear the bus by clocking up to 9 SCL pulses through GPIO, sending
+// a STOP, and then re-initializing the module. Each edge of the clear is a
+// TIMER1A step, so the master and slave interrupts are never blocked for it.
+//
+// A START is only issued on an idle bus. While another master holds it (BUSBSY
+// or SCL low) the attempt is deferred a byte time through TIMER1A, up to the
+// transaction deadline. SDA low with SCL idle high on two looks in a row is a
+// slave stuck part way through a byte, and only then is the bus cleared.
+//
+// Devices given a policy with setI2cDevicePolicy() have NACKs and lost
+// arbitration retried by the engine. The transaction keeps the bus while it
+// backs off, and TIMER1A (one-shot, shared by all buses, also used for the
+// deadlines and bus clears) restarts it once the backoff has elapsed, so
+// neither the caller nor the CPU waits on a busy device. With ackPoll set, a completed write is not reported until the
+// device acknowledges its address again, which is how EEPROM style parts
+// signal the end of their internal write cycle. The poll is a single byte
+// read, since the master cannot send an address without a data byte.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "i2c.h"
+#include "i2cslave.h"
+#include "itm.h"
+#include "dwt.h"
+
+#define PHASE_WRITE         0
+#define PHASE_READ          1
+#define PHASE_STOP          2               // error STOP in progress
+#define PHASE_PROBE         3               // ACK poll read
+
+#define CLOCK_LOW_LIMIT_US  25000           // SMBus clock-low limit
+#define MCLKOCNT_MAX        255             // CNTL counts 16 SCL periods
+#define RECOVERY_PULSES     9
+#define TIMEOUT_MARGIN      4               // deadline as a multiple of the ideal transfer time
+#define TIMEOUT_BITS        (2 * 9)         // addresses and START/STOP overhead
+#define BACKOFF_SHIFT_MAX   4               // retry backoff doubles up to 16x
+#define BUSY_DEFER_BITS     9               // look at a busy bus again after a byte time
+
+// Bus clear steps, half a bit period apart
+#define RECOVERY_IDLE       0
+#define RECOVERY_PULSE_LOW  1               // SCL released, pulse again while SDA is low
+#define RECOVERY_PULSE_HIGH 2
+#define RECOVERY_STOP_SCL   3
+#define RECOVERY_STOP_SDA   4
+#define RECOVERY_DONE       5
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _I2C_PINS
+{
+    PORT port;
+    uint8_t scl, sda;
+    uint32_t sclFn, sdaFn;
+} I2C_PINS;
+
+typedef struct _I2C_POLICY
+{
+    uint8_t add;
+    uint8_t attempts;
+    bool ackPoll;
+    uint32_t backoffCycles;
+} I2C_POLICY;
+
+typedef struct _I2C_STATE
+{
+    I2C_TRANSACTION* queue[I2C_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t tail;
+    I2C_TRANSACTION* active;
+    uint8_t phase;
+    uint8_t index;                          // bytes done in the current phase
+    uint8_t writeCount;                     // register byte plus tx bytes
+    uint8_t pendingStatus;                  // reported once the error STOP completes
+    bool stopIssued;                        // last command carried STOP
+    uint8_t lastStatus;
+    uint32_t bitRate;
+    uint32_t fcyc;
+    uint32_t startCycles;                   // when the active transaction started
+    uint32_t deadlineCycles;
+    uint32_t recoveries;
+    I2C_POLICY policies[I2C_POLICY_COUNT];
+    uint8_t policyCount;
+    I2C_POLICY* policy;                     // policy of the active transaction, 0 if none
+    uint8_t attempt;
+    bool probing;                           // ACK polling after a write
+    bool retryPending;                      // active transaction is backing off
+    uint32_t retryDue;                      // next TIMER1A step: backoff, deferred START or bus clear
+    uint32_t retries;
+    bool busyWait;                          // START deferred while the bus is in use
+    bool sdaLowSeen;                        // SDA was low with SCL high at the last look
+    volatile uint8_t recoveryStep;          // bus clear in progress, RECOVERY_IDLE if none
+    uint8_t recoveryPulses;
+    uint8_t recoveryStatus;                 // reported for the active transaction, I2C_OK restarts it
+    bool recoveryReleased;                  // SDA was high at the end of the last clear
+} I2C_STATE;
+
+static const uint8_t i2cVector[I2C_COUNT] = {INT_I2C0, INT_I2C1, INT_I2C2, INT_I2C3};
+
+static const I2C_PINS i2cPins[I2C_COUNT] =
+{
+    {PORTB, 2, 3, GPIO_PCTL_PB2_I2C0SCL, GPIO_PCTL_PB3_I2C0SDA},
+    {PORTA, 6, 7, GPIO_PCTL_PA6_I2C1SCL, GPIO_PCTL_PA7_I2C1SDA},
+    {PORTE, 4, 5, GPIO_PCTL_PE4_I2C2SCL, GPIO_PCTL_PE5_I2C2SDA},
+    {PORTD, 0, 1, GPIO_PCTL_PD0_I2C3SCL, GPIO_PCTL_PD1_I2C3SDA}
+};
+
+static I2C_STATE i2cState[I2C_COUNT];
+static bool retryTimerReady = false;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void configureI2cPins(uint8_t bus)
+{
+    const I2C_PINS* pins = &i2cPins[bus];
+    selectPinPushPullOutput(pins->port, pins->scl);
+    setPinAuxFunction(pins->port, pins->scl, pins->sclFn);
+    selectPinOpenDrainOutput(pins->port, pins->sda);
+    setPinAuxFunction(pins->port, pins->sda, pins->sdaFn);
+}
+
+static void configureI2cModule(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    uint32_t clockLow = (state->bitRate / 1000) * CLOCK_LOW_LIMIT_US / 1000 / 16;
+
+    I2C_REG(bus, I2C0_MCR_R) = 0;                       // disable to program
+    I2C_REG(bus, I2C0_MTPR_R) = state->fcyc / (20 * state->bitRate) - 1; // (fcyc/2) / (6+4) / (TPR+1) = bitRate
+    I2C_REG(bus, I2C0_MCR_R) = I2C_MCR_MFE | (isI2cSlaveEnabled(bus) ? I2C_MCR_SFE : 0);
+    I2C_REG(bus, I2C0_MCLKOCNT_R) = clockLow > MCLKOCNT_MAX ? MCLKOCNT_MAX : clockLow;
+    I2C_REG(bus, I2C0_MICR_R) = I2C_MICR_IC | I2C_MICR_CLKIC;
+    I2C_REG(bus, I2C0_MIMR_R) = I2C_MIMR_IM | I2C_MIMR_CLKIM;
+}
+
+// bitRate up to 400 kHz (standard and fast mode)
+void initI2c(uint8_t bus, uint32_t bitRate, uint32_t fcyc)
+{
+    I2C_STATE* state = &i2cState[bus];
+
+    // Enable clocks
+    SYSCTL_RCGCI2C_R |= 1 << bus;
+    _delay_cycles(3);
+    enablePort(i2cPins[bus].port);
+    initCycleCounter();
+
+    state->head = 0;
+    state->tail = 0;
+    state->active = 0;
+    state->lastStatus = I2C_OK;
+    state->bitRate = bitRate;
+    state->fcyc = fcyc;
+    state->recoveries = 0;
+    state->policyCount = 0;
+    state->retryPending = false;
+    state->retries = 0;
+    state->busyWait = false;
+    state->sdaLowSeen = false;
+    state->recoveryStep = RECOVERY_IDLE;
+
+    // Configure retry timer
+    if (!retryTimerReady)
+    {
+        SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+        _delay_cycles(3);
+        TIMER1_CTL_R &= ~TIMER_CTL_TAEN;             // turn-off timer before reconfiguring
+        TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;       // configure as 32-bit timer (A+B)
+        TIMER1_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;      // configure for one-shot mode (count down)
+        TIMER1_IMR_R = TIMER_IMR_TATOIM;
+        setNvicInterruptPriority(INT_TIMER1A, PRIORITY_BUS);
+        enableNvicInterrupt(INT_TIMER1A);
+        retryTimerReady = true;
+    }
+
+    // Configure I2C
+    configureI2cPins(bus);
+    configureI2cModule(bus);
+    I2C_REG(bus, I2C0_MCS_R) = I2C_MCS_STOP;
+    setNvicInterruptPriority(i2cVector[bus], PRIORITY_BUS);
+    enableNvicInterrupt(i2cVector[bus]);
+}
+
+// Releases a line by letting the pullup raise it (open-drain emulation)
+static void releaseI2cLine(PORT port, uint8_t pin)
+{
+    selectPinDigitalInput(port, pin);
+}
+
+static void driveI2cLineLow(PORT port, uint8_t pin)
+{
+    setPinValue(port, pin, 0);
+    selectPinOpenDrainOutput(port, pin);
+}
+
+static void completeTransaction(uint8_t bus, uint8_t status);
+static void startAttempt(uint8_t bus);
+static void startNext(uint8_t bus);
+static void armI2cTimer(void);
+
+// Runs the next timer step of the bus after cycles
+static void scheduleI2cEvent(uint8_t bus, uint32_t cycles)
+{
+    I2C_STATE* state = &i2cState[bus];
+    state->retryDue = DWT_CYCCNT_R + cycles;
+    state->retryPending = true;
+    armI2cTimer();
+}
+
+// Clears a bus held by a slave that is part way through a byte: clock SCL
+// until the slave lets SDA go, then generate a STOP and re-initialize
+// status is then reported for the active transaction, I2C_OK restarts it
+static void beginI2cRecovery(uint8_t bus, uint8_t status)
+{
+    const I2C_PINS* pins = &i2cPins[bus];
+    I2C_STATE* state = &i2cState[bus];
+
+    I2C_REG(bus, I2C0_MCR_R) = 0;
+    I2C_REG(bus, I2C0_MIMR_R) = 0;
+    setPinAuxFunction(pins->port, pins->scl, 0);
+    setPinAuxFunction(pins->port, pins->sda, 0);
+    releaseI2cLine(pins->port, pins->sda);
+    releaseI2cLine(pins->port, pins->scl);
+    state->recoveryStep = RECOVERY_PULSE_LOW;
+    state->recoveryPulses = 0;
+    state->recoveryStatus = status;
+    scheduleI2cEvent(bus, state->fcyc / (2 * state->bitRate));
+}
+
+static void finishI2cRecovery(uint8_t bus)
+{
+    const I2C_PINS* pins = &i2cPins[bus];
+    I2C_STATE* state = &i2cState[bus];
+
+    state->recoveryReleased = getPinValue(pins->port, pins->sda);
+    configureI2cPins(bus);
+    configureI2cModule(bus);
+    state->recoveries++;
+    state->recoveryStep = RECOVERY_IDLE;
+    if (!state->active)
+        startNext(bus);
+    else if (state->recoveryStatus != I2C_OK)
+        completeTransaction(bus, state->recoveryStatus);
+    else if (state->recoveryReleased)
+        startAttempt(bus);
+    else
+        completeTransaction(bus, I2C_BUS_STUCK);
+}
+
+// One edge of the bus clear, from TIMER1A
+static void stepI2cRecovery(uint8_t bus)
+{
+    const I2C_PINS* pins = &i2cPins[bus];
+    I2C_STATE* state = &i2cState[bus];
+    bool held;
+
+    switch (state->recoveryStep)
+    {
+        case RECOVERY_PULSE_LOW:
+            held = !getPinValue(pins->port, pins->sda);
+            driveI2cLineLow(pins->port, pins->scl);
+            if (held && state->recoveryPulses < RECOVERY_PULSES)
+            {
+                state->recoveryPulses++;
+                state->recoveryStep = RECOVERY_PULSE_HIGH;
+            }
+            else
+            {
+                driveI2cLineLow(pins->port, pins->sda);   // STOP: SDA rises while SCL is high
+                state->recoveryStep = RECOVERY_STOP_SCL;
+            }
+            break;
+        case RECOVERY_PULSE_HIGH:
+            releaseI2cLine(pins->port, pins->scl);
+            state->recoveryStep = RECOVERY_PULSE_LOW;
+            break;
+        case RECOVERY_STOP_SCL:
+            releaseI2cLine(pins->port, pins->scl);
+            state->recoveryStep = RECOVERY_STOP_SDA;
+            break;
+        case RECOVERY_STOP_SDA:
+            releaseI2cLine(pins->port, pins->sda);
+            state->recoveryStep = RECOVERY_DONE;
+            break;
+        default:
+            finishI2cRecovery(bus);
+            return;
+    }
+    scheduleI2cEvent(bus, state->fcyc / (2 * state->bitRate));
+}
+
+// Clears an idle bus and waits for the clear to finish
+// Must not be called at or above PRIORITY_BUS
+// Returns false if SDA is still held low or a transaction owns the bus
+bool recoverI2cBus(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    uint32_t section = enterNvicCriticalSection(PRIORITY_BUS);
+    bool idle = !state->active && state->recoveryStep == RECOVERY_IDLE;
+
+    if (idle)
+        beginI2cRecovery(bus, I2C_OK);
+    leaveNvicCriticalSection(section);
+    if (!idle)
+        return false;
+    while (state->recoveryStep != RECOVERY_IDLE)
+        checkI2cTimeout(bus);               // steps the clear even with TIMER1A masked
+    return state->recoveryReleased;
+}
+
+static uint8_t getWriteByte(I2C_STATE* state, uint8_t index)
+{
+    I2C_TRANSACTION* t = state->active;
+    if (t->useReg)
+        return index == 0 ? t->reg : t->tx[index - 1];
+    return t->tx[index];
+}
+
+// Remembers whether the command ends with STOP, since a failed command that
+// carried STOP leaves the controller idle with no STOP left to send
+static void issueI2cCommand(uint8_t bus, uint32_t command)
+{
+    i2cState[bus].stopIssued = (command & I2C_MCS_STOP) != 0;
+    I2C_REG(bus, I2C0_MCS_R) = command;
+}
+
+static void startRead(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    I2C_TRANSACTION* t = state->active;
+    state->phase = PHASE_READ;
+    state->index = 0;
+    I2C_REG(bus, I2C0_MSA_R) = (t->add << 1) | 1;       // add:r/~w=1
+    issueI2cCommand(bus, I2C_MCS_START | I2C_MCS_RUN | (t->rxCount > 1 ? I2C_MCS_ACK : I2C_MCS_STOP));
+}
+
+static I2C_POLICY* findPolicy(I2C_STATE* state, uint8_t add)
+{
+    uint8_t i;
+    for (i = 0; i < state->policyCount; i++)
+        if (state->policies[i].add == add)
+            return &state->policies[i];
+    return 0;
+}
+
+// Issues the active transaction, or its ACK poll, from the START
+static void startAttempt(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    I2C_TRANSACTION* t = state->active;
+    uint32_t mbmon = I2C_REG(bus, I2C0_MBMON_R);
+    bool busy = (I2C_REG(bus, I2C0_MCS_R) & I2C_MCS_BUSBSY) || !(mbmon & I2C_MBMON_SCL);
+
+    if (!state->busyWait)
+    {
+        state->startCycles = DWT_CYCCNT_R;
+        state->deadlineCycles = (state->fcyc / state->bitRate) * TIMEOUT_MARGIN
+                                * (TIMEOUT_BITS + 9 * (state->writeCount + t->rxCount));
+    }
+
+    // Wait for another master to finish, clear only a slave that keeps SDA low on an idle clock
+    if (busy || !(mbmon & I2C_MBMON_SDA))
+    {
+        if (DWT_CYCCNT_R - state->startCycles > state->deadlineCycles)
+        {
+            state->busyWait = false;
+            completeTransaction(bus, busy ? I2C_TIMEOUT : I2C_BUS_STUCK);
+        }
+        else if (!busy && state->sdaLowSeen)
+        {
+            state->busyWait = false;
+            state->sdaLowSeen = false;
+            beginI2cRecovery(bus, I2C_OK);
+        }
+        else
+        {
+            state->busyWait = true;
+            state->sdaLowSeen = !busy;
+            scheduleI2cEvent(bus, BUSY_DEFER_BITS * (state->fcyc / state->bitRate));
+        }
+        return;
+    }
+    state->busyWait = false;
+    state->sdaLowSeen = false;
+    state->startCycles = DWT_CYCCNT_R;
+    armI2cTimer();
+
+    if (state->probing)
+    {
+        state->phase = PHASE_PROBE;
+        I2C_REG(bus, I2C0_MSA_R) = (t->add << 1) | 1;   // add:r/~w=1
+        issueI2cCommand(bus, I2C_MCS_START | I2C_MCS_RUN | I2C_MCS_STOP);
+        return;
+    }
+    if (state->writeCount == 0)
+    {
+        startRead(bus);
+        return;
+    }
+    state->phase = PHASE_WRITE;
+    state->index = 0;
+    I2C_REG(bus, I2C0_MSA_R) = t->add << 1;              // add:r/~w=0
+    I2C_REG(bus, I2C0_MDR_R) = getWriteByte(state, 0);
+    issueI2cCommand(bus, I2C_MCS_START | I2C_MCS_RUN
+                         | (state->writeCount == 1 && t->rxCount == 0 ? I2C_MCS_STOP : 0));
+}
+
+// Starts the transaction at the head of the queue, if any
+static void startNext(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    I2C_TRANSACTION* t;
+
+    if (state->head == state->tail || state->recoveryStep != RECOVERY_IDLE)
+        return;
+    t = state->queue[state->tail];
+    state->tail = (state->tail + 1) % I2C_QUEUE_SIZE;
+    state->active = t;
+    state->writeCount = t->txCount + (t->useReg ? 1 : 0);
+    state->policy = findPolicy(state, t->add);
+    state->attempt = 0;
+    state->probing = false;
+    state->busyWait = false;
+    state->sdaLowSeen = false;
+    traceItm(ITM_PORT_I2C_START);
+    startAttempt(bus);
+}
+
+// Loads the timer for the earliest backoff or deadline still pending on any bus
+static void armI2cTimer(void)
+{
+    uint32_t now = DWT_CYCCNT_R;
+    uint32_t wait = 0;
+    uint32_t due, left;
+    uint8_t bus;
+    bool pending = false;
+
+    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    for (bus = 0; bus < I2C_COUNT; bus++)
+    {
+        I2C_STATE* state = &i2cState[bus];
+        if (state->retryPending)
+            due = state->retryDue;
+        else if (state->active)
+            due = state->startCycles + state->deadlineCycles + 1;
+        else
+            continue;
+        left = (int32_t)(due - now) > 0 ? due - now : 1;
+        if (!pending || left < wait)
+            wait = left;
+        pending = true;
+    }
+    if (pending)
+    {
+        TIMER1_TAILR_R = wait;
+        TIMER1_CTL_R |= TIMER_CTL_TAEN;
+    }
+}
+
+// Holds the bus idle for the policy backoff before the next attempt
+static void scheduleRetry(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    uint8_t shift = state->probing ? 0 : state->attempt - 1;   // ACK polls keep a steady rate
+
+    if (shift > BACKOFF_SHIFT_MAX)
+        shift = BACKOFF_SHIFT_MAX;
+    state->retries++;
+    scheduleI2cEvent(bus, state->policy->backoffCycles << shift);
+}
+
+static bool isRetryable(uint8_t status)
+{
+    return status == I2C_NACK_ADDRESS || status == I2C_NACK_DATA || status == I2C_ARB_LOST;
+}
+
+static void completeTransaction(uint8_t bus, uint8_t status)
+{
+    I2C_STATE* state = &i2cState[bus];
+    I2C_TRANSACTION* t = state->active;
+    state->active = 0;
+    state->probing = false;
+    state->retryPending = false;
+    state->lastStatus = status;
+    traceItm(ITM_PORT_I2C_STOP);
+    t->status = status;
+    if (t->callback)
+        t->callback(t);
+    startNext(bus);
+}
+
+// Applies the device policy to the outcome of one attempt
+static void endAttempt(uint8_t bus, uint8_t status)
+{
+    I2C_STATE* state = &i2cState[bus];
+    I2C_TRANSACTION* t = state->active;
+    I2C_POLICY* policy = state->policy;
+
+    if (policy)
+    {
+        state->attempt++;
+        if (state->probing)
+        {
+            if (status != I2C_OK && state->attempt < policy->attempts)
+            {
+                scheduleRetry(bus);
+                return;
+            }
+            if (status != I2C_OK)
+                status = I2C_DEVICE_BUSY;
+        }
+        else if (status == I2C_OK && policy->ackPoll && t->rxCount == 0)
+        {
+            state->probing = true;
+            state->attempt = 0;
+            scheduleRetry(bus);
+            return;
+        }
+        else if (isRetryable(status) && state->attempt < policy->attempts)
+        {
+            scheduleRetry(bus);
+            return;
+        }
+    }
+    completeTransaction(bus, status);
+}
+
+// Sets the retry policy for a device, replacing any earlier one
+// attempts counts the first try (1 disables retries) and also bounds the ACK polls
+// backoffUs is the idle time before a retry, doubling on each further NACK
+// Call after initI2c; returns false if the policy table is full
+bool setI2cDevicePolicy(uint8_t bus, uint8_t add, uint8_t attempts, uint32_t backoffUs, bool ackPoll)
+{
+    I2C_STATE* state = &i2cState[bus];
+    uint32_t section = enterNvicCriticalSection(PRIORITY_BUS);
+    I2C_POLICY* policy = findPolicy(state, add);
+    bool ok = true;
+
+    if (!policy && state->policyCount < I2C_POLICY_COUNT)
+        policy = &state->policies[state->policyCount++];
+    if (policy)
+    {
+        policy->add = add;
+        policy->attempts = attempts ? attempts : 1;
+        policy->ackPoll = ackPoll;
+        policy->backoffCycles = backoffUs * (state->fcyc / 1000000);
+    }
+    else
+        ok = false;
+    leaveNvicCriticalSection(section);
+    return ok;
+}
+
+// Queues a transaction
+// Returns false, with the reason in status, if it moves no data
+// (I2C_INVALID) or the queue is full (I2C_QUEUE_FULL)
+bool queueI2cTransaction(uint8_t bus, I2C_TRANSACTION* transaction)
+{
+    I2C_STATE* state = &i2cState[bus];
+    uint8_t next = (state->head + 1) % I2C_QUEUE_SIZE;
+    uint32_t section;
+    bool ok = false;
+
+    if (transaction->txCount + transaction->rxCount + transaction->useReg == 0)
+    {
+        transaction->status = I2C_INVALID;
+        return false;
+    }
+    transaction->status = I2C_PENDING;
+    section = enterNvicCriticalSection(PRIORITY_BUS);
+    if (next != state->tail)
+    {
+        state->queue[state->head] = transaction;
+        state->head = next;
+        if (!state->active)
+            startNext(bus);
+        ok = true;
+    }
+    else
+        transaction->status = I2C_QUEUE_FULL;
+    leaveNvicCriticalSection(section);
+    return ok;
+}
+
+// Runs the timer step of the bus once it is due (a retry backoff, a deferred
+// START or an edge of a bus clear), otherwise aborts the active transaction if
+// it has overrun its deadline
+// The TIMER1A interrupt does this on its own, the blocking waits also call it
+// so a wait made with the timer masked still ends
+// Returns true if a transaction overran its deadline, it ends with
+// I2C_TIMEOUT once the bus is cleared
+bool checkI2cTimeout(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    uint32_t section = enterNvicCriticalSection(PRIORITY_BUS);
+    uint32_t now = DWT_CYCCNT_R;
+    bool expired = false;
+
+    if (state->retryPending)
+    {
+        if ((int32_t)(now - state->retryDue) >= 0)
+        {
+            state->retryPending = false;
+            if (state->recoveryStep != RECOVERY_IDLE)
+                stepI2cRecovery(bus);
+            else
+                startAttempt(bus);
+        }
+    }
+    else if (state->active && (now - state->startCycles) > state->deadlineCycles)
+    {
+        expired = true;
+        beginI2cRecovery(bus, I2C_TIMEOUT);
+    }
+    leaveNvicCriticalSection(section);
+    return expired;
+}
+
+uint8_t waitI2cTransaction(uint8_t bus, I2C_TRANSACTION* transaction)
+{
+    while (transaction->status == I2C_PENDING)
+        checkI2cTimeout(bus);
+    return transaction->status;
+}
+
+// Queues and waits
+static uint8_t runI2cTransaction(uint8_t bus, I2C_TRANSACTION* t)
+{
+    t->callback = 0;
+    if (!queueI2cTransaction(bus, t))
+    {
+        i2cState[bus].lastStatus = t->status;
+        return t->status;
+    }
+    return waitI2cTransaction(bus, t);
+}
+
+// For simple devices with a single internal register
+uint8_t writeI2cData(uint8_t bus, uint8_t add, uint8_t data)
+{
+    I2C_TRANSACTION t = {add, 0, false, &data, 1, 0, 0};
+    return runI2cTransaction(bus, &t);
+}
+
+uint8_t readI2cData(uint8_t bus, uint8_t add)
+{
+    uint8_t data = 0;
+    I2C_TRANSACTION t = {add, 0, false, 0, 0, &data, 1};
+    runI2cTransaction(bus, &t);
+    return data;
+}
+
+// For devices with multiple registers
+uint8_t writeI2cRegister(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data)
+{
+    I2C_TRANSACTION t = {add, reg, true, &data, 1, 0, 0};
+    return runI2cTransaction(bus, &t);
+}
+
+uint8_t writeI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, const uint8_t data[], uint8_t size)
+{
+    I2C_TRANSACTION t = {add, reg, true, data, size, 0, 0};
+    return runI2cTransaction(bus, &t);
+}
+
+uint8_t readI2cRegister(uint8_t bus, uint8_t add, uint8_t reg)
+{
+    uint8_t data = 0;
+    I2C_TRANSACTION t = {add, reg, true, 0, 0, &data, 1};
+    runI2cTransaction(bus, &t);
+    return data;
+}
+
+uint8_t readI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data[], uint8_t size)
+{
+    I2C_TRANSACTION t = {add, reg, true, 0, 0, data, size};
+    return runI2cTransaction(bus, &t);
+}
+
+// General functions
+bool pollI2cAddress(uint8_t bus, uint8_t add)
+{
+    uint8_t data;
+    I2C_TRANSACTION t = {add, 0, false, 0, 0, &data, 1};
+    return runI2cTransaction(bus, &t) == I2C_OK;
+}
+
+// True if the last completed transaction on the bus failed
+bool isI2cError(uint8_t bus)
+{
+    return i2cState[bus].lastStatus != I2C_OK;
+}
+
+// Status of the last completed transaction on the bus
+uint8_t getI2cStatus(uint8_t bus)
+{
+    return i2cState[bus].lastStatus;
+}
+
+uint32_t getI2cRecoveries(uint8_t bus)
+{
+    return i2cState[bus].recoveries;
+}
+
+// Attempts and ACK polls scheduled by device policies
+uint32_t getI2cRetries(uint8_t bus)
+{
+    return i2cState[bus].retries;
+}
+
+// Advances the active transaction by one byte
+static void serviceI2c(uint8_t bus)
+{
+    I2C_STATE* state = &i2cState[bus];
+    I2C_TRANSACTION* t = state->active;
+    uint32_t mcs;
+
+    if (I2C_REG(bus, I2C0_MRIS_R) & I2C_MRIS_CLKRIS)    // SCL held low past the limit
+    {
+        I2C_REG(bus, I2C0_MICR_R) = I2C_MICR_CLKIC | I2C_MICR_IC;
+        beginI2cRecovery(bus, I2C_CLOCK_TIMEOUT);
+        return;
+    }
+    I2C_REG(bus, I2C0_MICR_R) = I2C_MICR_IC;
+    if (!t)
+        return;
+    if (state->phase == PHASE_STOP)
+    {
+        endAttempt(bus, state->pendingStatus);
+        return;
+    }
+
+    mcs = I2C_REG(bus, I2C0_MCS_R);
+    if (mcs & I2C_MCS_ERROR)
+    {
+        if (mcs & I2C_MCS_ARBLST)                        // another master owns the bus, no STOP
+        {
+            endAttempt(bus, I2C_ARB_LOST);
+            return;
+        }
+        state->pendingStatus = (mcs & I2C_MCS_ADRACK) ? I2C_NACK_ADDRESS : I2C_NACK_DATA;
+        if (state->stopIssued && !(mcs & I2C_MCS_BUSBSY)) // STOP already sent, no interrupt follows
+        {
+            endAttempt(bus, state->pendingStatus);
+            return;
+        }
+        state->phase = PHASE_STOP;
+        issueI2cCommand(bus, I2C_MCS_STOP);
+        return;
+    }
+
+    if (state->phase == PHASE_PROBE)
+    {
+        I2C_REG(bus, I2C0_MDR_R);                       // the byte only proves the device answered
+        endAttempt(bus, I2C_OK);
+    }
+    else if (state->phase == PHASE_WRITE)
+    {
+        state->index++;
+        if (state->index < state->writeCount)
+        {
+            I2C_REG(bus, I2C0_MDR_R) = getWriteByte(state, state->index);
+            issueI2cCommand(bus, I2C_MCS_RUN
+                | (state->index == state->writeCount - 1 && t->rxCount == 0 ? I2C_MCS_STOP : 0));
+        }
+        else if (t->rxCount)
+            startRead(bus);
+        else
+            endAttempt(bus, I2C_OK);
+    }
+    else
+    {
+        t->rx[state->index++] = I2C_REG(bus, I2C0_MDR_R);
+        if (state->index == t->rxCount)
+            endAttempt(bus, I2C_OK);
+        else
+            issueI2cCommand(bus, I2C_MCS_RUN | (t->rxCount - state->index > 1 ? I2C_MCS_ACK : I2C_MCS_STOP));
+    }
+}
+
+// The master and slave share the module vector
+static void serviceI2cInterrupt(uint8_t bus)
+{
+    if (I2C_REG(bus, I2C0_SMIS_R))
+        serviceI2cSlave(bus);
+    if (I2C_REG(bus, I2C0_MMIS_R))
+        serviceI2c(bus);
+}
+
+void i2c0Isr(void)
+{
+    serviceI2cInterrupt(I2C0);
+}
+
+void i2c1Isr(void)
+{
+    serviceI2cInterrupt(I2C1);
+}
+
+void i2c2Isr(void)
+{
+    serviceI2cInterrupt(I2C2);
+}
+
+void i2c3Isr(void)
+{
+    serviceI2cInterrupt(I2C3);
+}
+
+// Runs the due timer step of every bus and aborts every transaction past
+// its deadline
+void timer1aIsr(void)
+{
+    uint8_t bus;
+
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+    for (bus = 0; bus < I2C_COUNT; bus++)
+        checkI2cTimeout(bus);
+    armI2cTimer();
+}
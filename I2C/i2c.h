@@ -0,0 +1,110 @@
+// I2C Library
+// Jason Losh
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// I2C0: SCL PB2, SDA PB3
+// I2C1: SCL PA6, SDA PA7
+// I2C2: SCL PE4, SDA PE5
+// I2C3: SCL PD0, SDA PD1
+// 2kohm pullups on SDA and SCL of every bus in use
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef I2C_H_
+#define I2C_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C0 0
+#define I2C1 1
+#define I2C2 2
+#define I2C3 3
+#define I2C_COUNT 4
+
+// Register of a module by its I2C0 name, shared by i2c.c and i2cslave.c
+// The four modules sit 4 kB apart from 0x40020000, so no base table is needed
+#define I2C_MODULE_STRIDE   0x1000
+#define I2C_REG(bus, reg)   (*((volatile uint32_t *)((uintptr_t)&(reg) + (bus) * I2C_MODULE_STRIDE)))
+
+#define I2C_QUEUE_SIZE 8                    // queued transactions per bus
+#define I2C_POLICY_COUNT 4                  // devices with a retry policy per bus
+
+// Transaction status
+#define I2C_PENDING         0
+#define I2C_OK              1
+#define I2C_NACK_ADDRESS    2
+#define I2C_NACK_DATA       3
+#define I2C_ARB_LOST        4
+#define I2C_CLOCK_TIMEOUT   5               // a device held SCL low past the clock-low limit
+#define I2C_TIMEOUT         6               // no progress within the transaction deadline
+#define I2C_BUS_STUCK       7               // SDA still low after the bus clear
+#define I2C_QUEUE_FULL      8
+#define I2C_DEVICE_BUSY     9               // write done, but the device never answered an ACK poll
+#define I2C_INVALID         10              // refused before queueing, moves no data
+
+struct _I2C_TRANSACTION;
+typedef void (*I2C_CALLBACK)(struct _I2C_TRANSACTION* transaction);
+
+// Caller owned, must stay valid until status leaves I2C_PENDING
+// Writes reg (if useReg) and txCount bytes, then reads rxCount bytes after a
+// repeated start
+typedef struct _I2C_TRANSACTION
+{
+    uint8_t add;
+    uint8_t reg;
+    bool useReg;
+    const uint8_t* tx;
+    uint8_t txCount;
+    uint8_t* rx;
+    uint8_t rxCount;
+    I2C_CALLBACK callback;                  // runs from the I2C ISR, may be 0
+    volatile uint8_t status;
+} I2C_TRANSACTION;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initI2c(uint8_t bus, uint32_t bitRate, uint32_t fcyc);
+bool queueI2cTransaction(uint8_t bus, I2C_TRANSACTION* transaction);
+uint8_t waitI2cTransaction(uint8_t bus, I2C_TRANSACTION* transaction);
+bool checkI2cTimeout(uint8_t bus);
+bool recoverI2cBus(uint8_t bus);
+uint8_t getI2cStatus(uint8_t bus);
+uint32_t getI2cRecoveries(uint8_t bus);
+bool setI2cDevicePolicy(uint8_t bus, uint8_t add, uint8_t attempts, uint32_t backoffUs, bool ackPoll);
+uint32_t getI2cRetries(uint8_t bus);
+
+// For simple devices with a single internal register
+// Writes return a status, reads return the data (status from getI2cStatus)
+uint8_t writeI2cData(uint8_t bus, uint8_t add, uint8_t data);
+uint8_t readI2cData(uint8_t bus, uint8_t add);
+
+// For devices with multiple registers
+uint8_t writeI2cRegister(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data);
+uint8_t writeI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, const uint8_t data[], uint8_t size);
+uint8_t readI2cRegister(uint8_t bus, uint8_t add, uint8_t reg);
+uint8_t readI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data[], uint8_t size);
+
+// General functions
+bool pollI2cAddress(uint8_t bus, uint8_t add);
+bool isI2cError(uint8_t bus);
+
+void i2c0Isr(void);
+void i2c1Isr(void);
+void i2c2Isr(void);
+void i2c3Isr(void);
+void timer1aIsr(void);
+
+#endif
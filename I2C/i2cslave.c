@@ -0,0 +1,164 @@
+// I2C Slave Register File Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Shares the module and pins of the bus with the master in i2c.c
+
+// Presents a RAM array to a host as a register-file device. The first byte
+// of a host write sets the register pointer and later bytes are stored at the
+// pointer, which auto-increments and wraps at the end of the map. Host reads
+// return the byte at the pointer. Every byte is moved by the data interrupt
+// straight from or to RAM, so SCL is only stretched for the ISR entry.
+// Callbacks run once per host transaction rather than per byte to keep the
+// per-byte path short. The master and slave share one vector, so i2c.c
+// passes slave interrupts here.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "i2c.h"
+#include "i2cslave.h"
+
+#define SPAN_NONE           0
+#define SPAN_WRITE          1
+#define SPAN_READ           2
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _I2C_SLAVE
+{
+    uint8_t* regs;
+    const uint8_t* writeMask;               // bits the host may change, 0 if all
+    uint8_t size;
+    uint8_t pointer;
+    uint8_t span;                           // kind of access since the last START
+    uint8_t first;
+    uint8_t count;
+    bool enabled;
+    I2C_SLAVE_CALLBACK onWrite;
+    I2C_SLAVE_CALLBACK onRead;
+} I2C_SLAVE;
+
+static I2C_SLAVE slaves[I2C_COUNT];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Call after initI2c, which owns the clocks, pins and vector of the bus
+// writeMask has one byte per register (0 for read-only) or is 0 for all writable
+void initI2cSlave(uint8_t bus, uint8_t add, uint8_t regs[], uint8_t size, const uint8_t writeMask[])
+{
+    I2C_SLAVE* slave = &slaves[bus];
+
+    slave->regs = regs;
+    slave->writeMask = writeMask;
+    slave->size = size;
+    slave->pointer = 0;
+    slave->span = SPAN_NONE;
+    slave->enabled = true;
+
+    I2C_REG(bus, I2C0_SOAR_R) = add;
+    I2C_REG(bus, I2C0_SICR_R) = I2C_SICR_DATAIC | I2C_SICR_STARTIC | I2C_SICR_STOPIC;
+    I2C_REG(bus, I2C0_SIMR_R) = I2C_SIMR_DATAIM | I2C_SIMR_STARTIM | I2C_SIMR_STOPIM;
+    I2C_REG(bus, I2C0_MCR_R) |= I2C_MCR_SFE;
+    I2C_REG(bus, I2C0_SCSR_R) = I2C_SCSR_DA;
+}
+
+void setI2cSlaveCallbacks(uint8_t bus, I2C_SLAVE_CALLBACK onWrite, I2C_SLAVE_CALLBACK onRead)
+{
+    slaves[bus].onWrite = onWrite;
+    slaves[bus].onRead = onRead;
+}
+
+void stopI2cSlave(uint8_t bus)
+{
+    slaves[bus].enabled = false;
+    I2C_REG(bus, I2C0_SCSR_R) = 0;
+    I2C_REG(bus, I2C0_SIMR_R) = 0;
+    I2C_REG(bus, I2C0_MCR_R) &= ~I2C_MCR_SFE;
+}
+
+// Lets the master restore SFE when it re-initializes the module
+bool isI2cSlaveEnabled(uint8_t bus)
+{
+    return slaves[bus].enabled;
+}
+
+// Reports the access since the last START to the application
+static void endSpan(I2C_SLAVE* slave)
+{
+    if (slave->span == SPAN_WRITE && slave->count && slave->onWrite)
+        slave->onWrite(slave->first, slave->count);
+    else if (slave->span == SPAN_READ && slave->onRead)
+        slave->onRead(slave->first, slave->count);
+    slave->span = SPAN_NONE;
+}
+
+static void beginSpan(I2C_SLAVE* slave, uint8_t span)
+{
+    if (slave->span != span)
+    {
+        endSpan(slave);
+        slave->span = span;
+        slave->first = slave->pointer;
+        slave->count = 0;
+    }
+}
+
+// Called from the bus ISR when the slave has a masked interrupt
+void serviceI2cSlave(uint8_t bus)
+{
+    I2C_SLAVE* slave = &slaves[bus];
+    uint32_t mis = I2C_REG(bus, I2C0_SMIS_R);
+    uint32_t scsr;
+    uint8_t data, mask;
+
+    I2C_REG(bus, I2C0_SICR_R) = mis;
+    if (mis & I2C_SMIS_STARTMIS)
+        endSpan(slave);
+    if (mis & I2C_SMIS_DATAMIS)
+    {
+        scsr = I2C_REG(bus, I2C0_SCSR_R);
+        if (scsr & I2C_SCSR_TREQ)
+        {
+            beginSpan(slave, SPAN_READ);
+            I2C_REG(bus, I2C0_SDR_R) = slave->regs[slave->pointer];
+            slave->pointer = (slave->pointer + 1) % slave->size;
+            slave->count++;
+        }
+        else if (scsr & I2C_SCSR_RREQ)
+        {
+            data = I2C_REG(bus, I2C0_SDR_R);
+            if (scsr & I2C_SCSR_FBR)                     // register pointer
+            {
+                endSpan(slave);
+                slave->pointer = data % slave->size;
+            }
+            else
+            {
+                beginSpan(slave, SPAN_WRITE);
+                mask = slave->writeMask ? slave->writeMask[slave->pointer] : 0xFF;
+                slave->regs[slave->pointer] = (slave->regs[slave->pointer] & ~mask) | (data & mask);
+                slave->pointer = (slave->pointer + 1) % slave->size;
+                slave->count++;
+            }
+        }
+    }
+    if (mis & I2C_SMIS_STOPMIS)
+        endSpan(slave);
+}
@@ -1,5 +1,5 @@
-// I2C0 Library
-// Jason Losh
+// I2C Slave Register File Library
+// Prithvi Bhat
 
 //-----------------------------------------------------------------------------
 // Hardware Target
@@ -10,35 +10,30 @@
 // System Clock:    40 MHz
 
 // Hardware configuration:
-// I2C devices on I2C bus 0 with 2kohm pullups on SDA and SCL
+// Shares the module and pins of the bus with the master in i2c.c
 
 //-----------------------------------------------------------------------------
 // Device includes, defines, and assembler directives
 //-----------------------------------------------------------------------------
 
-#ifndef I2C0_H_
-#define I2C0_H_
+#ifndef I2C_SLAVE_H_
+#define I2C_SLAVE_H_
 
 #include <stdint.h>
 #include <stdbool.h>
 
+// Called from the I2C ISR when a host transaction ends (repeated START or
+// STOP) with the first register and the number of bytes it covered
+typedef void (*I2C_SLAVE_CALLBACK)(uint8_t first, uint8_t count);
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
-void initI2c0(void);
-// For simple devices with a single internal register
-void writeI2c0Data(uint8_t add, uint8_t data);
-uint8_t readI2c0Data(uint8_t add);
-
-// For devices with multiple registers
-void writeI2c0Register(uint8_t add, uint8_t reg, uint8_t data);
-void writeI2c0Registers(uint8_t add, uint8_t reg, const uint8_t data[], uint8_t size);
-uint8_t readI2c0Register(uint8_t add, uint8_t reg);
-void readI2c0Registers(uint8_t add, uint8_t reg, uint8_t data[], uint8_t size);
-
-// General functions
-bool pollI2c0Address(uint8_t add);
-bool isI2c0Error(void);
+void initI2cSlave(uint8_t bus, uint8_t add, uint8_t regs[], uint8_t size, const uint8_t writeMask[]);
+void setI2cSlaveCallbacks(uint8_t bus, I2C_SLAVE_CALLBACK onWrite, I2C_SLAVE_CALLBACK onRead);
+void stopI2cSlave(uint8_t bus);
+bool isI2cSlaveEnabled(uint8_t bus);
+void serviceI2cSlave(uint8_t bus);
 
 #endif
@@ -0,0 +1,63 @@
+// ITM Trace Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// SWO on PC3 (TDO/SWO), captured by the debug probe in SWD mode
+
+// Each event is a single 32-bit write of the DWT cycle count to the stimulus
+// port that identifies the event, so an event is one ITM packet and cannot be
+// split by a nested interrupt. tools/itm_decode.c rebuilds the timeline from a
+// captured SWO byte stream.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ITM_H_
+#define ITM_H_
+
+#include <stdint.h>
+#include "dwt.h"
+
+#define ITM_STIM_R(n)       (*((volatile uint32_t *)((uintptr_t)0xE0000000 + 4 * (n))))
+#define ITM_TER_R           (*((volatile uint32_t *)0xE0000E00))
+#define ITM_TCR_R           (*((volatile uint32_t *)0xE0000E80))
+#define ITM_LAR_R           (*((volatile uint32_t *)0xE0000FB0))
+
+// Stimulus port assignment, shared with tools/itm_decode.c
+#define ITM_PORT_TEXT       0               // reserved for text output
+#define ITM_PORT_SPI_START  1               // SPI frame start (CS asserted)
+#define ITM_PORT_SPI_STOP   2               // SPI frame stop (CS deasserted)
+#define ITM_PORT_I2C_START  3               // I2C transaction start
+#define ITM_PORT_I2C_STOP   4               // I2C transaction stop
+#define ITM_PORT_ISR_ENTER  8               // + ISR id (0-7)
+#define ITM_PORT_ISR_EXIT   16              // + ISR id (0-7)
+
+// ISR ids
+#define ITM_ISR_PORTE       0
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initItm(uint32_t swoBaud, uint32_t fcyc);
+
+// Cycle stamped event, skipped at the cost of one load when the port is disabled
+static inline void traceItm(uint8_t port)
+{
+    if (ITM_TER_R & (1u << port))
+    {
+        while (!(ITM_STIM_R(port) & 1));    // wait for stimulus FIFO space
+        ITM_STIM_R(port) = DWT_CYCCNT_R;
+    }
+}
+
+#endif
@@ -0,0 +1,55 @@
+// Interrupt Latency Harness
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Expander INT line looped back to PC4 (WT0CCP0) for edge capture
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Stages measured from the INT edge, shared by the SPI and I2C builds so the
+// results can be compared directly
+#define LATENCY_ISR_ENTRY   0               // PORTE_ISR entered
+#define LATENCY_BUS_FIRST   1               // first expander bus transaction complete
+#define LATENCY_LED_WRITE   2               // LED write complete
+#define LATENCY_STAGES      3
+
+#define LATENCY_BINS        16              // histogram bins per stage, the last bin collects overflows
+
+typedef struct _LATENCY_STATS
+{
+    uint32_t count;
+    uint32_t min;                           // cycles
+    uint32_t max;                           // cycles
+    uint64_t sum;                           // cycles
+    uint32_t bins[LATENCY_BINS];            // bin i holds latencies of [i, i+1) << binShift cycles
+} LATENCY_STATS;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initLatencyHarness(uint8_t binShift);
+void clearLatencyStats(void);
+bool startLatencyEvent(void);
+void markLatency(uint8_t stage);
+void getLatencyStats(uint8_t stage, LATENCY_STATS* stats);
+uint32_t getLatencyAverage(uint8_t stage);
+uint32_t getCycleCount(void);
+
+#endif
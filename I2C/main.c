@@ -8,8 +8,12 @@
 #include "gpio.h"
 #include "clock.h"
 #include "nvic.h"
-#include "i2c0.h"
+#include "i2c.h"
 #include "wait.h"
+#include "../common/ring.h"
+#include "latency.h"
+#include "uart0.h"
+#include "itm.h"
 
 // TM4C Pins
 #define PIN_TM4C_PORTD_CHIP_SELECT  PORTD,1     // IO expander chip select
@@ -18,6 +22,9 @@
 #define PIN_TM4C_IIC_SCL            PORTB,2     // I2C SCL
 #define PIN_TM4C_IIC_SDA            PORTB,3     // I2C SDA
 
+// TM4C I2C module wired to the expander
+#define EXPANDER_I2C                I2C0
+
 // TM4C special values
 #define PORT_E_INTERRUPT_VECTOR     20          // Interrupt vector number for PORT E
 
@@ -43,10 +50,26 @@
 #define PIN_MCP23008_INTCAP         0x08        // Register address to read interrupt capture values
 #define PIN_MCP23008_GPIO           0x09        // Register address to access GPIO bits
 
+// Log record ids
+#define LOG_ID_PORTE_ISR            1           // arg = unused
+#define LOG_ID_INTCAP               2           // arg = interrupt capture value
+#define LOG_ID_BUTTON               3           // arg = button press count
+
 // Misc Values
 #define LOGIC_LOW                   0
 #define LOGIC_HIGH                  1
 #define SYSTEM_CLK                  40e6        // System clock is configured for 40MHz operation
+#define I2C_BITRATE                 100000      // Standard mode I2C
+#define EXPANDER_ATTEMPTS           3           // Retries for a NACK from the expander
+#define EXPANDER_BACKOFF_US         100         // Bus idle time before the first retry
+#define SWO_BAUD                    2000000     // ITM trace rate on SWO
+#define LOG_BAUD                    115200      // UART0 log baud rate
+#define LATENCY_BIN_SHIFT           11          // 2048 cycle (51.2us) latency histogram bins
+#define INTCAP_RING_SIZE            16          // Interrupt captures buffered for the main loop (power of 2)
+
+RING_BUFFER intcap_ring;                        // Interrupt captures passed from PORTE_ISR to main
+uint8_t intcap_data[INTCAP_RING_SIZE];
+uint32_t button_presses;
 
 void initialise_interrupt_pins(void)
 {
@@ -58,6 +81,7 @@ void initialise_interrupt_pins(void)
 
     clearPinInterrupt(PIN_TM4C_PORTE_INT);               // Clear any older, stray interrupts
     enablePinInterrupt(PIN_TM4C_PORTE_INT);              // Initialize Interrupt on PE01
+    setNvicInterruptPriority(PORT_E_INTERRUPT_VECTOR, PRIORITY_GPIO);
     enableNvicInterrupt(PORT_E_INTERRUPT_VECTOR);
 }
 
@@ -68,7 +92,11 @@ void init_TM4C_hardware(void)
 {
       initSystemClockTo40Mhz();                           // Initialize system clock
       enablePort(PORTE);                                  // Initialize clocks on PORTE
-      initI2c0();                                         // Initialize IIC interface
+      initI2c(EXPANDER_I2C, I2C_BITRATE, SYSTEM_CLK);    // Initialize IIC interface
+      setI2cDevicePolicy(EXPANDER_I2C, SLAVE_MCP23008_ADDR, EXPANDER_ATTEMPTS, EXPANDER_BACKOFF_US, false); // Retry NACKs, no write cycle to poll
+      initLatencyHarness(LATENCY_BIN_SHIFT);              // Time INT edge to ISR and bus completion
+      initUart0Log(LOG_BAUD, SYSTEM_CLK);                 // Binary event log on the ICDI virtual COM port
+      initItm(SWO_BAUD, SYSTEM_CLK);                      // Cycle stamped ISR and I2C transaction trace
       initialise_interrupt_pins();                        // Initialize interrupt
 }
 
@@ -77,17 +105,25 @@ void init_TM4C_hardware(void)
 **/
 void PORTE_ISR()
 {
-    writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x00);      // Set LED pins if button has been pressed
+    startLatencyEvent();
+    traceItm(ITM_PORT_ISR_ENTER + ITM_ISR_PORTE);
+    writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x00); // Set LED pins if button has been pressed
+    markLatency(LATENCY_BUS_FIRST);                                       // First transaction is the LED write
+    markLatency(LATENCY_LED_WRITE);
+    logUart0(LOG_ID_PORTE_ISR, 0);
     waitMicrosecond(100000);
 
-    writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x20);      // Set LED pins if button has been pressed
+    writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x20); // Set LED pins if button has been pressed
 
     waitMicrosecond(100000);
 
-    readI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_INTCAP);           // Read interrupt register on the IO expander to clear interrupt
+    uint8_t capture = readI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_INTCAP); // Read interrupt register to clear interrupt
+    pushRing(&intcap_ring, capture);                                      // Pass capture to main
+    logUart0(LOG_ID_INTCAP, capture);
 
-    writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x40);      // Set Red LED
+    writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x40); // Set Red LED
     clearPinInterrupt(PIN_TM4C_PORTE_INT);
+    traceItm(ITM_PORT_ISR_EXIT + ITM_ISR_PORTE);
 }
 
 /**
@@ -96,17 +132,25 @@ void PORTE_ISR()
 void main(void)
 {
 
+      initRing(&intcap_ring, intcap_data, INTCAP_RING_SIZE);
       init_TM4C_hardware();
       // GPIO controls
-      writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_IODIR, VAL_MCP23008_IODIR);       // Set pin directions (bit 07 = input; others = output)
+      writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_IODIR, VAL_MCP23008_IODIR);     // Set pin directions (bit 07 = input; others = output)
 
       // Interrupt controls
-      writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_DEFVAL, VAL_MCP23008_DEFVAL);     // Set interrupt trigger condition
-      writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_INTCON, VAL_MCP23008_INTCON);     // Controls how the associated pin value is compared for interrupt-on-change
-      writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_GPINTEN, VAL_MCP23008_GPINTEN);   // Enable GPIO input pin for interrupt-on-change event
+      writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_DEFVAL, VAL_MCP23008_DEFVAL);   // Set interrupt trigger condition
+      writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_INTCON, VAL_MCP23008_INTCON);   // Controls how the associated pin value is compared for interrupt-on-change
+      writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_GPINTEN, VAL_MCP23008_GPINTEN); // Enable GPIO input pin for interrupt-on-change event
 
-      writeI2c0Register(SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x40);                      // Set Green LED pins
+      writeI2cRegister(EXPANDER_I2C, SLAVE_MCP23008_ADDR, PIN_MCP23008_GPIO, 0x40);                    // Set Green LED pins
 
       while(true)                                                                           // Run infinitely
-      {}
+      {
+            uint8_t capture;
+            while (popRing(&intcap_ring, &capture))                     // Handle interrupt captures outside the ISR
+            {
+                  if (!(capture & 0x80))                                // Button (bit 7) is active low
+                        logUart0(LOG_ID_BUTTON, ++button_presses);
+            }
+      }
 }
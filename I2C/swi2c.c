@@ -0,0 +1,345 @@
+// Software I2C Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// SCL and SDA on any GPIO pins of ports A-F
+// External pullups on SDA and SCL (2kohm for 400 kHz)
+
+// Extra buses for devices that share an address. Each line keeps a data
+// value of 0 and is switched between driven low (DIR=1) and released (DIR=0)
+// through its bit-band alias, so a line is never driven high and a write
+// touches only its own pin. Every SCL rise waits for the line to read high,
+// which lets slaves stretch the clock, and gives up after the SMBus clock-low
+// limit. Half bit periods are timed from the DWT cycle counter against the
+// previous edge, so the rate holds as long as the loop fits in a half
+// period (about fcyc / 200 at most, 400 kHz at 80 MHz). If an interrupt
+// delays an edge, the next half period is timed from the late edge so the
+// slave never sees a short phase.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "i2c.h"
+#include "swi2c.h"
+#include "dwt.h"
+
+// Bit-band word offsets from a DATA bit to the same bit of another register
+#define OFS_DATA_TO_DIR     (1*4*8)
+#define OFS_DATA_TO_ODR     (68*4*8)
+
+#define CLOCK_LOW_LIMIT_US  25000           // SMBus clock-low limit
+#define RECOVERY_PULSES     9
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _SW_I2C
+{
+    volatile uint32_t* sclDir;
+    volatile uint32_t* sdaDir;
+    volatile uint32_t* scl;
+    volatile uint32_t* sda;
+    uint32_t halfCycles;
+    uint32_t stretchCycles;
+    uint32_t edge;                          // cycle count of the last edge
+    uint8_t lastStatus;
+} SW_I2C;
+
+static SW_I2C swI2c[SW_I2C_COUNT];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Line access, one bit-band store or load each
+static inline void releaseScl(SW_I2C* b)
+{
+    *b->sclDir = 0;
+}
+
+static inline void driveSclLow(SW_I2C* b)
+{
+    *b->sclDir = 1;
+}
+
+static inline void setSda(SW_I2C* b, bool value)
+{
+    *b->sdaDir = !value;
+}
+
+static inline bool readSda(SW_I2C* b)
+{
+    return *b->sda;
+}
+
+// Waits half a bit period from the last edge
+static void waitHalfBit(SW_I2C* b)
+{
+    uint32_t target = b->edge + b->halfCycles;
+    uint32_t now;
+
+    while ((int32_t)((now = DWT_CYCCNT_R) - target) < 0);
+    b->edge = (now - target > b->halfCycles) ? now : target;   // preempted, restart from here
+}
+
+// Releases SCL and waits while a slave stretches it
+static bool raiseScl(SW_I2C* b)
+{
+    uint32_t start = DWT_CYCCNT_R;
+
+    releaseScl(b);
+    while (!*b->scl)
+    {
+        if (DWT_CYCCNT_R - start > b->stretchCycles)
+            return false;
+        b->edge = DWT_CYCCNT_R;
+    }
+    return true;
+}
+
+// START, or a repeated START when SCL is low after a byte
+static uint8_t sendStart(SW_I2C* b)
+{
+    setSda(b, 1);
+    waitHalfBit(b);
+    if (!raiseScl(b))
+        return I2C_CLOCK_TIMEOUT;
+    waitHalfBit(b);
+    if (!readSda(b))
+        return I2C_ARB_LOST;
+    setSda(b, 0);
+    waitHalfBit(b);
+    driveSclLow(b);
+    return I2C_OK;
+}
+
+static uint8_t sendStop(SW_I2C* b)
+{
+    setSda(b, 0);
+    waitHalfBit(b);
+    if (!raiseScl(b))
+        return I2C_CLOCK_TIMEOUT;
+    waitHalfBit(b);
+    setSda(b, 1);
+    waitHalfBit(b);
+    return I2C_OK;
+}
+
+// Clocks one bit out and back in; a released 1 read back as 0 means another
+// master won arbitration (ignored for ACK slots, which the slave drives)
+static uint8_t clockBit(SW_I2C* b, bool out, bool* in)
+{
+    setSda(b, out);
+    waitHalfBit(b);
+    if (!raiseScl(b))
+        return I2C_CLOCK_TIMEOUT;
+    *in = readSda(b);
+    waitHalfBit(b);
+    driveSclLow(b);
+    return I2C_OK;
+}
+
+// Sends a byte MSB first and returns its ACK as I2C_OK or nack
+static uint8_t writeByte(SW_I2C* b, uint8_t data, uint8_t nack)
+{
+    uint8_t i, status;
+    bool in;
+
+    for (i = 0; i < 8; i++)
+    {
+        bool out = (data >> (7 - i)) & 1;
+        if ((status = clockBit(b, out, &in)) != I2C_OK)
+            return status;
+        if (out && !in)
+            return I2C_ARB_LOST;
+    }
+    if ((status = clockBit(b, 1, &in)) != I2C_OK)
+        return status;
+    return in ? nack : I2C_OK;
+}
+
+static uint8_t readByte(SW_I2C* b, uint8_t* data, bool ack)
+{
+    uint8_t i, status;
+    bool in;
+
+    *data = 0;
+    for (i = 0; i < 8; i++)
+    {
+        if ((status = clockBit(b, 1, &in)) != I2C_OK)
+            return status;
+        *data = (*data << 1) | in;
+    }
+    return clockBit(b, !ack, &in);
+}
+
+void initSwI2c(uint8_t bus, PORT sclPort, uint8_t sclPin, PORT sdaPort, uint8_t sdaPin,
+               uint32_t bitRate, uint32_t fcyc)
+{
+    SW_I2C* b = &swI2c[bus];
+
+    enablePort(sclPort);
+    enablePort(sdaPort);
+    initCycleCounter();
+
+    b->scl = (uint32_t*)sclPort + sclPin;
+    b->sda = (uint32_t*)sdaPort + sdaPin;
+    b->sclDir = b->scl + OFS_DATA_TO_DIR;
+    b->sdaDir = b->sda + OFS_DATA_TO_DIR;
+    b->halfCycles = fcyc / (2 * bitRate);
+    b->stretchCycles = (fcyc / 1000000) * CLOCK_LOW_LIMIT_US;
+    b->lastStatus = I2C_OK;
+
+    // Released inputs with a 0 latched, open drain in case DIR is set by mistake
+    selectPinDigitalInput(sclPort, sclPin);
+    selectPinDigitalInput(sdaPort, sdaPin);
+    *(b->scl + OFS_DATA_TO_ODR) = 1;
+    *(b->sda + OFS_DATA_TO_ODR) = 1;
+    *b->scl = 0;
+    *b->sda = 0;
+    b->edge = DWT_CYCCNT_R;
+}
+
+// Clocks SCL until a slave part way through a byte lets SDA go, then STOPs
+// Returns false if SDA is still held low
+bool recoverSwI2cBus(uint8_t bus)
+{
+    SW_I2C* b = &swI2c[bus];
+    uint8_t i;
+
+    b->edge = DWT_CYCCNT_R;
+    setSda(b, 1);
+    for (i = 0; i < RECOVERY_PULSES && !readSda(b); i++)
+    {
+        driveSclLow(b);
+        waitHalfBit(b);
+        if (!raiseScl(b))
+            return false;
+        waitHalfBit(b);
+    }
+    driveSclLow(b);
+    waitHalfBit(b);
+    sendStop(b);
+    return readSda(b);
+}
+
+// Writes reg (if useReg) and txCount bytes, then reads rxCount bytes after a
+// repeated start, as a queued transaction on the hardware driver does
+uint8_t runSwI2cTransaction(uint8_t bus, I2C_TRANSACTION* t)
+{
+    SW_I2C* b = &swI2c[bus];
+    uint8_t status = I2C_OK;
+    uint8_t i;
+
+    b->edge = DWT_CYCCNT_R;
+    if (!readSda(b) && !recoverSwI2cBus(bus))
+        status = I2C_BUS_STUCK;
+    if (status == I2C_OK && (t->useReg || t->txCount || !t->rxCount))
+    {
+        status = sendStart(b);
+        if (status == I2C_OK)
+            status = writeByte(b, t->add << 1, I2C_NACK_ADDRESS);      // add:r/~w=0
+        if (status == I2C_OK && t->useReg)
+            status = writeByte(b, t->reg, I2C_NACK_DATA);
+        for (i = 0; status == I2C_OK && i < t->txCount; i++)
+            status = writeByte(b, t->tx[i], I2C_NACK_DATA);
+    }
+    if (status == I2C_OK && t->rxCount)
+    {
+        status = sendStart(b);
+        if (status == I2C_OK)
+            status = writeByte(b, (t->add << 1) | 1, I2C_NACK_ADDRESS); // add:r/~w=1
+        for (i = 0; status == I2C_OK && i < t->rxCount; i++)
+            status = readByte(b, &t->rx[i], i < t->rxCount - 1);
+    }
+    // Arbitration loss leaves the bus to the other master, which needs SCL
+    // released to finish its clock (SDA is already released by the lost bit)
+    if (status == I2C_ARB_LOST)
+        releaseScl(b);
+    else if (status != I2C_BUS_STUCK)
+    {
+        uint8_t stop = sendStop(b);
+        if (status == I2C_OK)
+            status = stop;
+    }
+
+    b->lastStatus = status;
+    t->status = status;
+    if (t->callback)
+        t->callback(t);
+    return status;
+}
+
+// Status of the last transaction on the bus
+uint8_t getSwI2cStatus(uint8_t bus)
+{
+    return swI2c[bus].lastStatus;
+}
+
+// For simple devices with a single internal register
+uint8_t writeSwI2cData(uint8_t bus, uint8_t add, uint8_t data)
+{
+    I2C_TRANSACTION t = {add, 0, false, &data, 1, 0, 0};
+    return runSwI2cTransaction(bus, &t);
+}
+
+uint8_t readSwI2cData(uint8_t bus, uint8_t add)
+{
+    uint8_t data = 0;
+    I2C_TRANSACTION t = {add, 0, false, 0, 0, &data, 1};
+    runSwI2cTransaction(bus, &t);
+    return data;
+}
+
+// For devices with multiple registers
+uint8_t writeSwI2cRegister(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data)
+{
+    I2C_TRANSACTION t = {add, reg, true, &data, 1, 0, 0};
+    return runSwI2cTransaction(bus, &t);
+}
+
+uint8_t writeSwI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, const uint8_t data[], uint8_t size)
+{
+    I2C_TRANSACTION t = {add, reg, true, data, size, 0, 0};
+    return runSwI2cTransaction(bus, &t);
+}
+
+uint8_t readSwI2cRegister(uint8_t bus, uint8_t add, uint8_t reg)
+{
+    uint8_t data = 0;
+    I2C_TRANSACTION t = {add, reg, true, 0, 0, &data, 1};
+    runSwI2cTransaction(bus, &t);
+    return data;
+}
+
+uint8_t readSwI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data[], uint8_t size)
+{
+    I2C_TRANSACTION t = {add, reg, true, 0, 0, data, size};
+    return runSwI2cTransaction(bus, &t);
+}
+
+// General functions
+bool pollSwI2cAddress(uint8_t bus, uint8_t add)
+{
+    I2C_TRANSACTION t = {add, 0, false, 0, 0, 0, 0};
+    return runSwI2cTransaction(bus, &t) == I2C_OK;
+}
+
+bool isSwI2cError(uint8_t bus)
+{
+    return swI2c[bus].lastStatus != I2C_OK;
+}
@@ -0,0 +1,60 @@
+// Software I2C Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// SCL and SDA on any GPIO pins of ports A-F
+// External pullups on SDA and SCL (2kohm for 400 kHz)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SWI2C_H_
+#define SWI2C_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+#include "i2c.h"
+
+#define SW_I2C0 0
+#define SW_I2C1 1
+#define SW_I2C2 2
+#define SW_I2C3 3
+#define SW_I2C_COUNT 4
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Mirrors i2c.h and reports the same status codes, but every call blocks
+// until the transaction is on the wire and complete
+void initSwI2c(uint8_t bus, PORT sclPort, uint8_t sclPin, PORT sdaPort, uint8_t sdaPin,
+               uint32_t bitRate, uint32_t fcyc);
+uint8_t runSwI2cTransaction(uint8_t bus, I2C_TRANSACTION* transaction);
+bool recoverSwI2cBus(uint8_t bus);
+uint8_t getSwI2cStatus(uint8_t bus);
+
+// For simple devices with a single internal register
+uint8_t writeSwI2cData(uint8_t bus, uint8_t add, uint8_t data);
+uint8_t readSwI2cData(uint8_t bus, uint8_t add);
+
+// For devices with multiple registers
+uint8_t writeSwI2cRegister(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data);
+uint8_t writeSwI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, const uint8_t data[], uint8_t size);
+uint8_t readSwI2cRegister(uint8_t bus, uint8_t add, uint8_t reg);
+uint8_t readSwI2cRegisters(uint8_t bus, uint8_t add, uint8_t reg, uint8_t data[], uint8_t size);
+
+// General functions
+bool pollSwI2cAddress(uint8_t bus, uint8_t add);
+bool isSwI2cError(uint8_t bus);
+
+#endif
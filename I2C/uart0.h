@@ -0,0 +1,48 @@
+// UART0 Log Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// UART Interface:
+//   U0TX (PA1) and U0RX (PA0) are connected to the 2nd controller
+//   The USB on the 2nd controller enumerates to an ICDI interface and a virtual COM port
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef UART0_H_
+#define UART0_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_SYNC    0xA5                    // first byte of every record on the wire
+#define LOG_SLOTS   64                      // records buffered, must be a power of 2
+
+// 8-byte binary record, sent little-endian
+typedef struct _LOG_RECORD
+{
+    uint8_t sync;
+    uint8_t id;                             // application defined event id
+    uint16_t arg;                           // event argument
+    uint32_t timestamp;                     // DWT cycle count
+} LOG_RECORD;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initUart0Log(uint32_t baudRate, uint32_t fcyc);
+bool logUart0(uint8_t id, uint16_t arg);
+uint32_t getUart0LogDropped(void);
+void uart0Isr(void);
+
+#endif
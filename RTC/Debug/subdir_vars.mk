@@ -8,6 +8,8 @@ CMD_SRCS += \
 
 C_SRCS += \
 ../clock.c \
+../crash.c \
+../energy.c \
 ../gpio.c \
 ../hibernation.c \
 ../main.c \
@@ -18,6 +20,8 @@ C_SRCS += \
 
 C_DEPS += \
 ./clock.d \
+./crash.d \
+./energy.d \
 ./gpio.d \
 ./hibernation.d \
 ./main.d \
@@ -28,6 +32,8 @@ C_DEPS += \
 
 OBJS += \
 ./clock.obj \
+./crash.obj \
+./energy.obj \
 ./gpio.obj \
 ./hibernation.obj \
 ./main.obj \
@@ -38,6 +44,8 @@ OBJS += \
 
 OBJS__QUOTED += \
 "clock.obj" \
+"crash.obj" \
+"energy.obj" \
 "gpio.obj" \
 "hibernation.obj" \
 "main.obj" \
@@ -48,6 +56,8 @@ OBJS__QUOTED += \
 
 C_DEPS__QUOTED += \
 "clock.d" \
+"crash.d" \
+"energy.d" \
 "gpio.d" \
 "hibernation.d" \
 "main.d" \
@@ -58,6 +68,8 @@ C_DEPS__QUOTED += \
 
 C_SRCS__QUOTED += \
 "../clock.c" \
+"../crash.c" \
+"../energy.c" \
 "../gpio.c" \
 "../hibernation.c" \
 "../main.c" \
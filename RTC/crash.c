@@ -0,0 +1,102 @@
+// Crash capture functions
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Fault handlers and the watchdog first-timeout interrupt save the stacked
+// context and fault status registers to a NOINIT RAM record, then let the
+// device reset. The record survives the reset and is read out on the next boot.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "crash.h"
+
+#define CRASH_MAGIC 0xDEADC0DE
+
+// Exception frame stacked by the processor on entry
+#define FRAME_LR    5
+#define FRAME_PC    6
+#define FRAME_XPSR  7
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// Not initialized by the C runtime, so the contents survive a reset
+#pragma NOINIT(crashRecord)
+static CRASH_RECORD crashRecord;
+
+static CRASH_RECORD lastCrash;
+static bool lastCrashValid;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Call once at boot, before anything else is traced
+// Moves any captured crash out of the NOINIT record and enables the
+// configurable faults so they are reported with their own cause
+// The trace starts empty on every boot, after a cold boot the NOINIT RAM
+// holds power-on garbage and after a crash the trace has been copied
+void initCrashCapture()
+{
+    uint8_t i;
+    lastCrashValid = (crashRecord.magic == CRASH_MAGIC);
+    if (lastCrashValid)
+        lastCrash = crashRecord;
+    crashRecord.magic = 0;
+    crashRecord.traceIndex = 0;
+    for (i = 0; i < CRASH_TRACE_SIZE; i++)
+        crashRecord.trace[i] = 0;
+    NVIC_SYS_HND_CTRL_R |= NVIC_SYS_HND_CTRL_USAGE | NVIC_SYS_HND_CTRL_BUS | NVIC_SYS_HND_CTRL_MEM;
+}
+
+// Record a trace point; the last CRASH_TRACE_SIZE points are kept in the crash record
+// Callable from any context, a point traced by an ISR that preempts another
+// trace may overwrite it
+void traceCrash(uint32_t id)
+{
+    crashRecord.trace[crashRecord.traceIndex++ & (CRASH_TRACE_SIZE - 1)] = id;
+}
+
+// Save the crash context, frame is the exception frame of the interrupted code
+void captureCrash(uint32_t cause, const uint32_t* frame, uint32_t detail)
+{
+    crashRecord.cause = cause;
+    crashRecord.pc = frame[FRAME_PC];
+    crashRecord.lr = frame[FRAME_LR];
+    crashRecord.xpsr = frame[FRAME_XPSR];
+    crashRecord.cfsr = NVIC_FAULT_STAT_R;
+    crashRecord.hfsr = NVIC_HFAULT_STAT_R;
+    crashRecord.mmfar = NVIC_MM_ADDR_R;
+    crashRecord.bfar = NVIC_FAULT_ADDR_R;
+    crashRecord.activeIsr = frame[FRAME_XPSR] & 0x1FF;
+    crashRecord.detail = detail;
+    crashRecord.magic = CRASH_MAGIC;
+}
+
+// Entered from FaultISR with the exception frame in R0
+void crashFaultHandler(const uint32_t* frame)
+{
+    captureCrash(NVIC_INT_CTRL_R & NVIC_INT_CTRL_VEC_ACT_M, frame, 0);
+    NVIC_APINT_R = NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ;
+    while(1);
+}
+
+// Returns the crash captured before the last reset, false if there was none
+bool getCrashRecord(CRASH_RECORD* record)
+{
+    if (lastCrashValid)
+        *record = lastCrash;
+    return lastCrashValid;
+}
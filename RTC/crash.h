@@ -0,0 +1,57 @@
+// Crash capture functions
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+#ifndef CRASH_H_
+#define CRASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CRASH_TRACE_SIZE 8                  // must be a power of 2
+
+// Crash causes
+#define CRASH_HARD_FAULT  3                 // matches the exception number of the fault
+#define CRASH_MM_FAULT    4
+#define CRASH_BUS_FAULT   5
+#define CRASH_USAGE_FAULT 6
+#define CRASH_WATCHDOG    (16 + 18)         // watchdog vector (INT_WATCHDOG)
+
+// Trace point ids, the source in the top byte and a source specific value below
+#define CRASH_TRACE_MAIN     0x01000000     // | main loop stage
+#define CRASH_TRACE_WATCHDOG 0x02000000     // | tasks seen at a watchdog feed
+
+typedef struct _CRASH_RECORD
+{
+    uint32_t magic;                         // CRASH_MAGIC when a crash has been captured
+    uint32_t cause;                         // exception number that captured the crash
+    uint32_t pc;                            // stacked context at the time of the crash
+    uint32_t lr;
+    uint32_t xpsr;
+    uint32_t cfsr;                          // fault status and address registers
+    uint32_t hfsr;
+    uint32_t mmfar;
+    uint32_t bfar;
+    uint32_t activeIsr;                     // exception number interrupted by the crash (0 = thread)
+    uint32_t detail;                        // cause specific, e.g. missed watchdog tasks
+    uint32_t traceIndex;
+    uint32_t trace[CRASH_TRACE_SIZE];       // last trace points, oldest at traceIndex
+} CRASH_RECORD;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initCrashCapture();
+void traceCrash(uint32_t id);
+void captureCrash(uint32_t cause, const uint32_t* frame, uint32_t detail);
+void crashFaultHandler(const uint32_t* frame);
+bool getCrashRecord(CRASH_RECORD* record);
+
+#endif
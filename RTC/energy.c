@@ -0,0 +1,235 @@
+/**
+ *      @file energy.c
+ *      @author Prithvi Bhat
+ *      @brief Power mode residency and energy accounting
+ *             Time in each mode is measured with the hibernation RTC, which keeps counting while the core
+ *             is powered down. Totals are kept in RAM while awake and flushed to battery-backed memory
+ *             before hibernating, so they accumulate across any number of hibernation cycles
+ *      @date 2022-10-12
+**/
+
+#include "tm4c123gh6pm.h"
+#include "energy.h"
+#include "hibernation.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ENERGY_MAGIC            0x454E5247          // "ENRG" marks valid totals in battery-backed memory
+#define RTC_TICKS_SHIFT         15                  // 32768 RTC ticks per second
+#define STORED_TICKS_SHIFT      7                   // Totals stored in 1/256s units (194 days per word)
+
+/**
+*      @brief Default current drawn in each mode in microamps
+*             Run is the measured value from Outputs/Report.txt. Hibernation measured below the 10uA meter
+*             resolution, so the datasheet VDD3ON figure is used. Sleep values are datasheet estimates
+**/
+static uint32_t mode_current_ua[MODE_COUNT] =
+{
+    18900,                                          // MODE_RUN
+    9000,                                           // MODE_SLEEP
+    1100,                                           // MODE_DEEP_SLEEP
+    5,                                              // MODE_HIBERNATE
+};
+
+static uint64_t residency[MODE_COUNT];              // Time in each mode in RTC ticks
+static uint32_t wakes_ext;
+static uint32_t wakes_rtc;
+static power_mode_t current_mode;
+static uint32_t last_timestamp;
+
+static energy_event_t event_log[ENERGY_LOG_SIZE];
+static uint8_t event_head;
+static uint8_t event_count;
+
+/**
+*      @brief Function to read the RTC as a single timestamp
+*      @return uint32_t RTC time in 1/32768s ticks
+**/
+static uint32_t get_rtc_timestamp(void)
+{
+    uint32_t seconds;
+    uint32_t subseconds;
+
+    do                                              // Re-read if the seconds counter rolled over
+    {
+        seconds = HIB_RTCC_R;
+        subseconds = HIB_RTCSS_R & HIB_RTCSS_RTCSSC_M;
+    } while (seconds != HIB_RTCC_R);
+
+    return (seconds << RTC_TICKS_SHIFT) + subseconds;
+}
+
+/**
+*      @brief Function to append a transition to the event log
+**/
+static void log_energy_event(uint32_t timestamp, power_mode_t mode, uint8_t cause)
+{
+    event_log[event_head].timestamp = timestamp;
+    event_log[event_head].mode = mode;
+    event_log[event_head].cause = cause;
+    event_head = (event_head + 1) % ENERGY_LOG_SIZE;
+    if (event_count < ENERGY_LOG_SIZE)
+        event_count++;
+}
+
+/**
+*      @brief Function to load totals from battery-backed memory and account for the time just spent in
+*             hibernation. Call once at boot, after the hibernation module is running
+**/
+void init_energy_accounting(void)
+{
+    bool woke = consume_hibernation_wake();         // false after a reset while awake
+    uint32_t cause = woke ? get_hibernation_wake_mode() & (HIB_RIS_EXTW | HIB_RIS_RTCALT0) : 0;
+    uint32_t now = get_rtc_timestamp();
+    uint8_t i;
+
+    if (read_hibernation_data(HIB_DATA_ENERGY_MAGIC) == ENERGY_MAGIC)
+    {
+        for (i = 0; i < MODE_COUNT; i++)
+            residency[i] = (uint64_t)read_hibernation_data(HIB_DATA_ENERGY_RESIDENCY + i) << STORED_TICKS_SHIFT;
+        wakes_ext = read_hibernation_data(HIB_DATA_ENERGY_WAKES) >> 16;
+        wakes_rtc = read_hibernation_data(HIB_DATA_ENERGY_WAKES) & 0xFFFF;
+
+        if (cause)                                  // hibernate() restarts the RTC at 0, so now is time asleep
+        {
+            residency[MODE_HIBERNATE] += now;
+            if (cause & HIB_RIS_EXTW)
+                wakes_ext++;
+            else
+                wakes_rtc++;
+        }
+    }
+    else
+    {
+        clear_energy_accounting();
+    }
+
+    current_mode = MODE_RUN;
+    last_timestamp = now;
+    log_energy_event(now, MODE_RUN, cause);
+}
+
+/**
+*      @brief Function to override the current drawn in a mode, e.g. after a bench measurement
+**/
+void set_energy_mode_current(power_mode_t mode, uint32_t microamps)
+{
+    if (mode < MODE_COUNT)
+        mode_current_ua[mode] = microamps;
+}
+
+/**
+*      @brief Function to record a transition into a new power mode
+*             Entering MODE_HIBERNATE flushes the totals since RAM is lost in hibernation
+**/
+void enter_energy_mode(power_mode_t mode)
+{
+    uint32_t now = get_rtc_timestamp();
+
+    residency[current_mode] += now - last_timestamp;
+    last_timestamp = now;
+    current_mode = mode;
+    log_energy_event(now, mode, 0);
+
+    if (mode == MODE_HIBERNATE)
+        flush_energy_accounting();
+}
+
+/**
+*      @brief Function to sleep until the next interrupt, accounting the time spent asleep
+**/
+void enter_sleep_mode(void)
+{
+    enter_energy_mode(MODE_SLEEP);
+    NVIC_SYS_CTRL_R &= ~NVIC_SYS_CTRL_SLEEPDEEP;
+    __asm("    WFI");
+    enter_energy_mode(MODE_RUN);
+}
+
+/**
+*      @brief Function to deep-sleep until the next interrupt, accounting the time spent asleep
+**/
+void enter_deep_sleep_mode(void)
+{
+    enter_energy_mode(MODE_DEEP_SLEEP);
+    NVIC_SYS_CTRL_R |= NVIC_SYS_CTRL_SLEEPDEEP;
+    __asm("    WFI");
+    NVIC_SYS_CTRL_R &= ~NVIC_SYS_CTRL_SLEEPDEEP;
+    enter_energy_mode(MODE_RUN);
+}
+
+/**
+*      @brief Function to save the running totals to battery-backed memory
+**/
+void flush_energy_accounting(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < MODE_COUNT; i++)
+        write_hibernation_data(HIB_DATA_ENERGY_RESIDENCY + i, residency[i] >> STORED_TICKS_SHIFT);
+    write_hibernation_data(HIB_DATA_ENERGY_WAKES, (wakes_ext << 16) | (wakes_rtc & 0xFFFF));
+    write_hibernation_data(HIB_DATA_ENERGY_MAGIC, ENERGY_MAGIC);
+}
+
+/**
+*      @brief Function to reset all totals, in RAM and in battery-backed memory
+**/
+void clear_energy_accounting(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < MODE_COUNT; i++)
+        residency[i] = 0;
+    wakes_ext = 0;
+    wakes_rtc = 0;
+    event_head = 0;
+    event_count = 0;
+    flush_energy_accounting();
+}
+
+/**
+*      @brief Function to build an energy report from the current totals
+*      @param report report to fill
+*      @param capacity_mah battery capacity used for the battery life estimate
+**/
+void get_energy_report(energy_report_t *report, uint32_t capacity_mah)
+{
+    uint64_t ticks[MODE_COUNT];
+    uint64_t total = 0;
+    uint64_t charge = 0;                            // uA x ticks
+    uint8_t i;
+
+    for (i = 0; i < MODE_COUNT; i++)
+        ticks[i] = residency[i];
+    ticks[current_mode] += get_rtc_timestamp() - last_timestamp;
+
+    for (i = 0; i < MODE_COUNT; i++)
+    {
+        report->residency_ms[i] = (ticks[i] * 1000) >> RTC_TICKS_SHIFT;
+        total += ticks[i];
+        charge += ticks[i] * mode_current_ua[i];
+    }
+    report->wakes_ext = wakes_ext;
+    report->wakes_rtc = wakes_rtc;
+    report->average_ua = total ? charge / total : mode_current_ua[MODE_RUN];
+    report->battery_life_h = report->average_ua ? ((uint64_t)capacity_mah * 1000) / report->average_ua : 0;
+}
+
+/**
+*      @brief Function to read the most recent mode transitions, oldest first
+*      @param log array to fill
+*      @param size number of entries available in log
+*      @return uint8_t number of entries written
+**/
+uint8_t get_energy_log(energy_event_t log[], uint8_t size)
+{
+    uint8_t first;
+    uint8_t i;
+
+    if (size > event_count)
+        size = event_count;
+    first = (event_head + ENERGY_LOG_SIZE - size) % ENERGY_LOG_SIZE;
+    for (i = 0; i < size; i++)
+        log[i] = event_log[(first + i) % ENERGY_LOG_SIZE];
+    return size;
+}
@@ -0,0 +1,61 @@
+/**
+ *      @file energy.h
+ *      @author Prithvi Bhat
+ *      @brief Power mode residency and energy accounting
+ *      @date 2022-10-12
+ **/
+
+#include "tm4c123gh6pm.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifndef ENERGY_H_
+#define ENERGY_H_
+
+#define ENERGY_LOG_SIZE     16                      // Number of mode transitions kept for readout
+
+/**
+*      @brief Enumeration of accounted power modes
+**/
+typedef enum
+{
+    MODE_RUN,
+    MODE_SLEEP,
+    MODE_DEEP_SLEEP,
+    MODE_HIBERNATE,
+    MODE_COUNT,
+}power_mode_t;
+
+/**
+*      @brief Record of a single power mode transition
+**/
+typedef struct
+{
+    uint32_t timestamp;                             // RTC time of the transition in 1/32768s ticks
+    uint8_t mode;                                   // Mode entered (power_mode_t)
+    uint8_t cause;                                  // HIB_RIS wake cause bits when resuming from hibernation
+}energy_event_t;
+
+/**
+*      @brief Energy report readable at runtime
+**/
+typedef struct
+{
+    uint32_t residency_ms[MODE_COUNT];              // Total time spent in each mode
+    uint32_t wakes_ext;                             // Hibernation wakes caused by the WAKE pin
+    uint32_t wakes_rtc;                             // Hibernation wakes caused by the RTC match
+    uint32_t average_ua;                            // Residency weighted average current
+    uint32_t battery_life_h;                        // Estimated battery life at the average current
+}energy_report_t;
+
+void init_energy_accounting(void);
+void set_energy_mode_current(power_mode_t mode, uint32_t microamps);
+void enter_energy_mode(power_mode_t mode);
+void enter_sleep_mode(void);
+void enter_deep_sleep_mode(void);
+void flush_energy_accounting(void);
+void clear_energy_accounting(void);
+void get_energy_report(energy_report_t *report, uint32_t capacity_mah);
+uint8_t get_energy_log(energy_event_t log[], uint8_t size);
+
+#endif /* ENERGY_H_ */
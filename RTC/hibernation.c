@@ -8,8 +8,23 @@
 #include "tm4c123gh6pm.h"
 #include "hibernation.h"
 #include <stdint.h>
+#include <stdbool.h>
 #include "gpio.h"
 
+#define RTC_TICKS_PER_SECOND    32768               // Nominal 32.768kHz crystal frequency
+#define RTC_TRIM_SECONDS        64                  // Trim is applied once every 64 seconds of RTC time
+#define RTC_TRIM_NONE           0x7FFF              // HIB_RTCT reset value, no correction applied
+#define RTC_TRIM_MAX_DELTA      0x0800              // Reject corrections beyond ~1000ppm as measurement faults
+#define RTC_CAL_MAX_WINDOW      64                  // Longest window before a 40MHz 32-bit timer count overflows
+
+#define HIB_DATA(n)             ((&HIB_DATA_R)[n])  // Battery-backed memory word n (16 words)
+#define GPIO_RETAIN_MAGIC       0xA0000000          // Marks a retained port image, confirmed by its complement
+#define GPIO_RETAIN_MAGIC_M     0xF0000000
+#define GPIO_RETAIN_PORT_S      24                  // Index of the retained port in ports[]
+#define GPIO_RETAIN_MASK_S      8                   // Retained pin mask
+#define GPIO_RETAIN_DATA_M      0x000000FF          // Retained pin levels
+#define HIBERNATED_MAGIC        0x48494245          // "HIBE" left in HIB_DATA by hibernate()
+
 /**
 *      @brief Enumeration of hibernation wake types
 **/
@@ -20,6 +35,45 @@ typedef enum
     WAKE_ON_LOW_BATT    = HIB_CTL_BATWKEN,
 }wake_mode_t;
 
+/**
+*      @brief Enumeration of RTC calibration states
+**/
+typedef enum
+{
+    CAL_IDLE,                                       // Waiting for the next scheduled calibration
+    CAL_SYNC,                                       // Waiting for an RTC second boundary to start the window
+    CAL_MEASURE,                                    // Counting reference clocks across the window
+}cal_state_t;
+
+/**
+*      @brief RTC calibration context
+**/
+typedef struct
+{
+    cal_state_t state;
+    uint32_t window;                                // Measurement window in RTC seconds
+    uint32_t period;                                // Seconds between periodic calibrations (0 = manual only)
+    uint32_t fcyc;                                  // Reference (PLL derived system) clock frequency
+    uint32_t second;                                // RTC second at which the current state was entered
+    uint32_t count;                                 // Reference timer value at the start of the window
+    uint32_t last;                                  // RTC second of the last completed calibration
+    uint16_t trim;                                  // Trim in effect before the current run
+}rtc_calibration_t;
+
+static rtc_calibration_t calibration;
+
+/**
+*      @brief GPIO retention context
+**/
+typedef struct
+{
+    uint8_t port;                                   // Index of the retained port in ports[]
+    uint8_t mask;                                   // Output pins to hold through hibernation (0 = disabled)
+}gpio_retention_t;
+
+static gpio_retention_t retention;
+static const PORT ports[] = {PORTA, PORTB, PORTC, PORTD, PORTE, PORTF};
+
 /**
 *      @brief Function to wait while register write is in progress
 **/
@@ -43,12 +97,148 @@ void init_hibernation_module(void)
     HIB_CTL_R |= HIB_CTL_RTCEN | HIB_CTL_VDD3ON;    // Enable RTC and VDD in the hibernation module
 }
 
+/**
+*      @brief Function to write a word of battery-backed memory
+*      @param index word in HIB_DATA (0-15)
+*      @param value value to store
+**/
+void write_hibernation_data(uint8_t index, uint32_t value)
+{
+    wait_write();
+    HIB_DATA(index) = value;
+    wait_write();
+}
+
+/**
+*      @brief Function to read a word of battery-backed memory
+*      @param index word in HIB_DATA (0-15)
+*      @return uint32_t stored value
+**/
+uint32_t read_hibernation_data(uint8_t index)
+{
+    return HIB_DATA(index);
+}
+
+/**
+*      @brief Function to hold output pins through hibernation
+*             In VDD3ON mode the pads stay powered while the core is off, so outputs keep driving their
+*             level. The pin levels are also saved to battery-backed memory so that the wake code can
+*             replay them data-first, before the pins are turned back into outputs
+*      @param port GPIO port with the pins to retain
+*      @param mask output pins to retain
+**/
+void enable_gpio_retention(PORT port, uint8_t mask)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(ports) / sizeof(ports[0]); i++)
+    {
+        if (ports[i] == port)
+        {
+            retention.port = i;
+            retention.mask = mask;
+        }
+    }
+    wait_write();
+    HIB_CTL_R |= HIB_CTL_VDD3ON;                    // Keep pads powered during hibernation
+}
+
+/**
+*      @brief Function to stop retaining pins; the next wake performs a full GPIO initialization
+**/
+void disable_gpio_retention(void)
+{
+    retention.mask = 0;
+    write_hibernation_data(HIB_DATA_GPIO_RETENTION, 0);
+    write_hibernation_data(HIB_DATA_GPIO_RETENTION_CHK, 0);
+}
+
+/**
+*      @brief Function to restore outputs retained through hibernation
+*             Output levels are written before the direction so the pins never glitch to the reset value
+*             The image is only trusted on the first boot after hibernate() (call before
+*             consume_hibernation_wake()) and when its complement copy matches, since battery-backed
+*             memory holds random values after a cold power-up. It is cleared once applied, so a later
+*             reset does not replay stale levels
+*      @return true if a retained port image was found and applied; the caller can skip output setup
+**/
+bool restore_retained_gpio(void)
+{
+    uint32_t image = read_hibernation_data(HIB_DATA_GPIO_RETENTION);
+    uint32_t check = read_hibernation_data(HIB_DATA_GPIO_RETENTION_CHK);
+    uint8_t index = (image >> GPIO_RETAIN_PORT_S) & 0x0F;
+    uint8_t mask = image >> GPIO_RETAIN_MASK_S;
+    uint8_t pin;
+
+    if (read_hibernation_data(HIB_DATA_HIBERNATED) != HIBERNATED_MAGIC)
+        return false;
+    if (check != ~image || (image & GPIO_RETAIN_MAGIC_M) != GPIO_RETAIN_MAGIC || index >= sizeof(ports) / sizeof(ports[0]))
+        return false;
+    write_hibernation_data(HIB_DATA_GPIO_RETENTION, 0);
+    write_hibernation_data(HIB_DATA_GPIO_RETENTION_CHK, 0);
+
+    enablePort(ports[index]);
+    for (pin = 0; pin < 8; pin++)
+    {
+        if (mask & (1 << pin))
+        {
+            setPinValue(ports[index], pin, (image >> pin) & 1);
+            selectPinPushPullOutput(ports[index], pin);
+        }
+    }
+    retention.port = index;
+    retention.mask = mask;
+    return true;
+}
+
+/**
+*      @brief Function to save the retained pin levels before entering hibernation
+**/
+static void save_retained_gpio(void)
+{
+    uint32_t image = GPIO_RETAIN_MAGIC;
+
+    image |= (uint32_t)retention.port << GPIO_RETAIN_PORT_S;
+    image |= (uint32_t)retention.mask << GPIO_RETAIN_MASK_S;
+    image |= getPortValue(ports[retention.port]) & retention.mask & GPIO_RETAIN_DATA_M;
+    write_hibernation_data(HIB_DATA_GPIO_RETENTION, image);
+    write_hibernation_data(HIB_DATA_GPIO_RETENTION_CHK, ~image);
+}
+
+/**
+*      @brief Function to program the RTC trim register
+*      @param trim value to load into HIB_RTCT (0x7FFF = no trim)
+**/
+static void set_rtc_trim(uint16_t trim)
+{
+    wait_write();
+    HIB_RTCT_R = trim;
+    wait_write();
+}
+
+/**
+*      @brief Function to carry the calibration schedule through hibernation
+*             hibernate() restarts the RTC at 0, so the time of the last calibration is stored relative
+*             to that restart. A run cut short by hibernation puts back the trim it cleared
+**/
+static void save_rtc_calibration(void)
+{
+    if (calibration.state != CAL_IDLE)
+    {
+        set_rtc_trim(calibration.trim);
+        calibration.state = CAL_IDLE;
+    }
+    write_hibernation_data(HIB_DATA_RTC_CAL_LAST, calibration.last - HIB_RTCC_R);
+}
+
 /**
 *      @brief Function to force uC to go into hibernate
 **/
 void hibernate(uint32_t seconds)
 {
-   disablePort(PORTF);
+    if (retention.mask)
+        save_retained_gpio();                       // Port clock and configuration stay as they are
+    save_rtc_calibration();
     HIB_CTL_R |= WAKE_ON_GPIO_PIN | WAKE_ON_RTC_MATCH;
     HIB_IC_R |= HIB_IC_WC | HIB_IC_EXTW;
 
@@ -58,6 +248,7 @@ void hibernate(uint32_t seconds)
     HIB_RTCSS_R = (seconds << 16);                  // Set value in sub-second register
     wait_write();
     HIB_RTCLD_R = 0;                                // Set load value for hibernation RTC
+    write_hibernation_data(HIB_DATA_HIBERNATED, HIBERNATED_MAGIC);
     HIB_CTL_R |= HIB_CTL_HIBREQ;                    // Request Board to go into hibernation
     // HIB_CTL_R = 0x0000015B;
 }
@@ -70,3 +261,131 @@ uint32_t get_hibernation_wake_mode(void)
 {
     return HIB_RIS_R;
 }
+
+/**
+*      @brief Function to tell a wake from hibernation apart from any other reset
+*             HIB_RIS keeps its wake bits until the next hibernate(), so a watchdog, fault or reset button
+*             reboot while awake still shows them. hibernate() leaves a marker in battery-backed memory
+*             instead, which this clears so each hibernation is reported once
+*      @return true on the first call after waking from hibernate()
+**/
+bool consume_hibernation_wake(void)
+{
+    if (read_hibernation_data(HIB_DATA_HIBERNATED) != HIBERNATED_MAGIC)
+        return false;
+    write_hibernation_data(HIB_DATA_HIBERNATED, 0);
+    return true;
+}
+
+/**
+*      @brief Function to start a free running, up counting 32-bit reference timer on TIMER1
+*             TIMER1 is clocked from the PLL derived system clock
+**/
+static void init_reference_timer(void)
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+    _delay_cycles(3);
+    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;                // Turn off timer before reconfiguring
+    TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;          // Configure as 32-bit timer (A+B)
+    TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD | TIMER_TAMR_TACDIR; // Periodic mode, count up
+    TIMER1_TAILR_R = 0xFFFFFFFF;                    // Free run across the full 32-bit range
+    TIMER1_CTL_R |= TIMER_CTL_TAEN;                 // Turn on timer
+}
+
+/**
+*      @brief Function to convert a completed measurement into a trim value
+*             The RTC stretches (or shortens) one second in every 64 by the difference between the trim
+*             value and 0x7FFF. The measured error over the window is scaled to a 64 second period
+*      @param cycles number of reference clocks counted across the window
+*      @return int32_t correction in RTC ticks per 64 seconds (positive = crystal runs fast)
+**/
+static int32_t get_rtc_correction(uint32_t cycles)
+{
+    int64_t expected = (int64_t)calibration.window * calibration.fcyc;
+    int64_t error = expected - (int64_t)cycles;      // Positive when RTC seconds elapse too quickly
+
+    return (int32_t)((error * RTC_TICKS_PER_SECOND * RTC_TRIM_SECONDS) / (int64_t)cycles);
+}
+
+/**
+*      @brief Function to configure RTC calibration against the PLL derived system clock
+*      @param window measurement window in RTC seconds (clamped to 1..64)
+*      @param period seconds between periodic calibrations, time in hibernation included (0 to disable)
+*             A calibration that falls due during hibernation runs once the device is awake
+*      @param fcyc system clock frequency in Hz
+**/
+void init_rtc_calibration(uint32_t window, uint32_t period, uint32_t fcyc)
+{
+    if (window == 0)
+        window = 1;
+    if (window > RTC_CAL_MAX_WINDOW)
+        window = RTC_CAL_MAX_WINDOW;
+
+    calibration.state = CAL_IDLE;
+    calibration.window = window;
+    calibration.period = period;
+    calibration.fcyc = fcyc;
+    calibration.second = HIB_RTCC_R;
+    calibration.last = read_hibernation_data(HIB_DATA_RTC_CAL_LAST); // Survives resets and hibernation
+    calibration.trim = HIB_RTCT_R & HIB_RTCT_TRIM_M;
+
+    init_reference_timer();
+}
+
+/**
+*      @brief Function to begin a calibration run, completed by service_rtc_calibration()
+*             Trim is cleared for the duration of the window so the measurement sees the raw crystal, the
+*             previous trim is put back if the result is rejected
+**/
+void start_rtc_calibration(void)
+{
+    if (calibration.state == CAL_IDLE)
+        calibration.trim = HIB_RTCT_R & HIB_RTCT_TRIM_M;
+    set_rtc_trim(RTC_TRIM_NONE);
+    calibration.second = HIB_RTCC_R;
+    calibration.state = CAL_SYNC;
+}
+
+/**
+*      @brief Function to advance the non-blocking calibration state machine; call from the idle loop
+*             Starts a new calibration once every period seconds when periodic calibration is enabled
+*      @return true when a new trim value has been programmed into HIB_RTCT
+**/
+bool service_rtc_calibration(void)
+{
+    uint32_t second = HIB_RTCC_R;
+    uint32_t count = TIMER1_TAV_R;
+    int32_t correction;
+
+    switch (calibration.state)
+    {
+        case CAL_IDLE:
+            if (calibration.period && (second - calibration.last) >= calibration.period)
+                start_rtc_calibration();
+            break;
+        case CAL_SYNC:
+            if (second != calibration.second)       // Window opens on a second boundary
+            {
+                calibration.second = second;
+                calibration.count = count;
+                calibration.state = CAL_MEASURE;
+            }
+            break;
+        case CAL_MEASURE:
+            if ((second - calibration.second) < calibration.window)
+                break;
+            calibration.state = CAL_IDLE;
+            calibration.second = second;
+            calibration.last = second;
+            write_hibernation_data(HIB_DATA_RTC_CAL_LAST, second);
+            correction = get_rtc_correction(count - calibration.count);
+            if (correction > RTC_TRIM_MAX_DELTA || correction < -RTC_TRIM_MAX_DELTA)
+            {
+                set_rtc_trim(calibration.trim);     // Keep the previous trim rather than apply a bad value
+                break;
+            }
+            set_rtc_trim(RTC_TRIM_NONE + correction);
+            return true;
+    }
+    return false;
+}
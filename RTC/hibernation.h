@@ -7,12 +7,35 @@
 
 #include "tm4c123gh6pm.h"
 #include "stdint.h"
+#include "stdbool.h"
+#include "gpio.h"
 
 #ifndef HIBERNATION_H_
 #define HIBERNATION_H_
 
+// Battery-backed memory (HIB_DATA) word allocation
+#define HIB_DATA_GPIO_RETENTION     0               // Port image held through hibernation
+#define HIB_DATA_ENERGY_MAGIC       1               // Marks valid energy accounting totals
+#define HIB_DATA_ENERGY_RESIDENCY   2               // Mode residency totals, one word per mode (2-5)
+#define HIB_DATA_ENERGY_WAKES       6               // Wake counts, EXT in bits 31:16, RTC in bits 15:0
+#define HIB_DATA_HIBERNATED         7               // Set by hibernate(), cleared by the first boot after it
+#define HIB_DATA_RTC_CAL_LAST       8               // RTC second of the last calibration
+#define HIB_DATA_GPIO_RETENTION_CHK 9               // Complement of the retained port image
+
 void init_hibernation_module(void);
 void hibernate(uint32_t seconds);
 uint32_t get_hibernation_wake_mode(void);
+bool consume_hibernation_wake(void);
+
+void write_hibernation_data(uint8_t index, uint32_t value);
+uint32_t read_hibernation_data(uint8_t index);
+
+void enable_gpio_retention(PORT port, uint8_t mask);
+void disable_gpio_retention(void);
+bool restore_retained_gpio(void);
+
+void init_rtc_calibration(uint32_t window, uint32_t period, uint32_t fcyc);
+void start_rtc_calibration(void);
+bool service_rtc_calibration(void);
 
 #endif /* HIBERNATION_H_ */
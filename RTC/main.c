@@ -1,85 +1,131 @@
-/**
- *      @file main.c
- *      @author Prithvi Bhat
- *      @brief Demonstrate Hibernation on TM4c123 using the RTC module
- *      @date 2022-10-05
- **/
-
-#include "clock.h"
-#include "gpio.h"
-#include "hibernation.h"
-#include "wd0.h"
-#include "tm4c123gh6pm.h"
-
-#define LED_RED             PORTF,1
-#define LED_BLUE            PORTF,2
-#define LED_GREEN           PORTF,3
-#define PUSH_BUTTON_WAKE    PORTF,0
-#define PUSH_BUTTON_SLEEP   PORTF,4
-
-#define EXT_WAKE            (get_hibernation_wake_mode() & HIB_RIS_EXTW)
-#define RTC_WAKE            (get_hibernation_wake_mode() & HIB_RIS_RTCALT0)
-
-/**
-*      @brief Function block operation until a button is pressed by user
-**/
-void wait_for_button_press(void)
-{
-    while (getPinValue(PUSH_BUTTON_SLEEP))  {}  // Check for button press (Low on Press)
-
-    // Set LEDs for visual confirmations
-    setPinValue(LED_BLUE, 0);
-    setPinValue(LED_RED, 0);
-    setPinValue(LED_GREEN, 0);
-    disablePort(PORTF);
-}
-
-/**
-*      @brief Function to initialize all necessary hardware on the device
-**/
-void init_TM4C_hardware(void)
-{
-    initSystemClockTo40Mhz();                 // Initialize system clock
-
-    enablePort(PORTF);                        // Initialize clocks on PORTF
-
-    selectPinPushPullOutput(LED_BLUE);        // Initialize PORTF pin 1 as an output
-    selectPinPushPullOutput(LED_RED);         // Initialize PORTF pin 2 as an output
-    selectPinPushPullOutput(LED_GREEN);       // Initialize PORTF pin 3 as an output
-    selectPinDigitalInput(PUSH_BUTTON_SLEEP); // Initialize PORTF pin 4 as an input
-    selectPinDigitalInput(PUSH_BUTTON_WAKE);  // Initialize PORTF pin 0 as an input
-    enablePinPullup(PUSH_BUTTON_SLEEP);       // Set Pull mode for push button input (Normally High)
-    enablePinPullup(PUSH_BUTTON_WAKE);        // Set Pull mode for push button input (Normally High)
-}
-
-/**
-*      @brief main function
-**/
-void main(void)
-{
-    init_TM4C_hardware();
-    setPinValue(LED_RED, 1);
-
-    if (!(HIB_CTL_R & HIB_CTL_CLK32EN))     // Initialise hibernation module only once
-    {
-        init_hibernation_module();
-    }
-
-    if(EXT_WAKE)                            // Check if wake was caused by external button press
-    {
-        setPinValue(LED_RED, 0);
-        setPinValue(LED_GREEN, 0);
-        setPinValue(LED_BLUE, 1);
-    }
-    else if (RTC_WAKE)                      // Check if wake was caused by timeout of RTC module
-    {
-        setPinValue(LED_RED, 1);
-        setPinValue(LED_BLUE, 0);
-        setPinValue(LED_GREEN, 0);
-    }
-
-    wait_for_button_press();
-
-    hibernate(5);
-    while(1)    {}
-}
+/**
+ *      @file main.c
+ *      @author Prithvi Bhat
+ *      @brief Demonstrate Hibernation on TM4c123 using the RTC module
+ *      @date 2022-10-05
+ **/
+
+#include "clock.h"
+#include "gpio.h"
+#include "hibernation.h"
+#include "energy.h"
+#include "wd0.h"
+#include "crash.h"
+#include "tm4c123gh6pm.h"
+
+#define LED_RED             PORTF,1
+#define LED_BLUE            PORTF,2
+#define LED_GREEN           PORTF,3
+#define PUSH_BUTTON_WAKE    PORTF,0
+#define PUSH_BUTTON_SLEEP   PORTF,4
+#define LED_MASK            0x0E                // PORTF pins 1-3 held through hibernation
+
+#define SYSTEM_CLK          40e6                // System clock is configured for 40MHz operation
+#define RTC_CAL_WINDOW      16                  // RTC calibration window in seconds
+#define RTC_CAL_PERIOD      600                 // Re-calibrate the RTC every 10 minutes, asleep or awake
+#define WATCHDOG_TIMEOUT    500000              // Watchdog supervisor period in microseconds
+#define MAIN_LOOP_DEADLINE  1000000             // Main loop must check in at least once a second
+
+// Crash trace points, the last few reached are kept with a fault or hang record
+#define TRACE_BOOT          (CRASH_TRACE_MAIN | 1)
+#define TRACE_HARDWARE      (CRASH_TRACE_MAIN | 2)
+#define TRACE_CALIBRATION   (CRASH_TRACE_MAIN | 3)
+#define TRACE_WAIT          (CRASH_TRACE_MAIN | 4)
+#define TRACE_HIBERNATE     (CRASH_TRACE_MAIN | 5)
+
+uint8_t main_loop_task;                         // Watchdog supervisor task for the main loop
+CRASH_RECORD last_crash;                        // Fault or hang captured before the last reset
+bool last_crash_valid;
+
+#define EXT_WAKE            (get_hibernation_wake_mode() & HIB_RIS_EXTW)
+#define RTC_WAKE            (get_hibernation_wake_mode() & HIB_RIS_RTCALT0)
+
+/**
+*      @brief Function block operation until a button is pressed by user
+**/
+void wait_for_button_press(void)
+{
+    while (getPinValue(PUSH_BUTTON_SLEEP))      // Check for button press (Low on Press)
+    {
+        service_rtc_calibration();              // Keep RTC trim up to date while awake
+        checkInWatchdog0Task(main_loop_task);
+    }
+
+    // Set LEDs for visual confirmations
+    setPinValue(LED_BLUE, 0);
+    setPinValue(LED_RED, 0);
+    setPinValue(LED_GREEN, 0);
+}
+
+/**
+*      @brief Function to initialize all necessary hardware on the device
+**/
+void init_TM4C_hardware(void)
+{
+    initSystemClockTo40Mhz();                 // Initialize system clock
+
+    enablePort(PORTF);                        // Initialize clocks on PORTF
+
+    if (!restore_retained_gpio())             // LEDs held through hibernation need no reconfiguration (before init_energy_accounting)
+    {
+        selectPinPushPullOutput(LED_BLUE);    // Initialize PORTF pin 1 as an output
+        selectPinPushPullOutput(LED_RED);     // Initialize PORTF pin 2 as an output
+        selectPinPushPullOutput(LED_GREEN);   // Initialize PORTF pin 3 as an output
+    }
+    selectPinDigitalInput(PUSH_BUTTON_SLEEP); // Initialize PORTF pin 4 as an input
+    selectPinDigitalInput(PUSH_BUTTON_WAKE);  // Initialize PORTF pin 0 as an input
+    enablePinPullup(PUSH_BUTTON_SLEEP);       // Set Pull mode for push button input (Normally High)
+    enablePinPullup(PUSH_BUTTON_WAKE);        // Set Pull mode for push button input (Normally High)
+
+    initWatchdog0(WATCHDOG_TIMEOUT, SYSTEM_CLK);
+    main_loop_task = registerWatchdog0Task(MAIN_LOOP_DEADLINE);
+}
+
+/**
+*      @brief main function
+**/
+void main(void)
+{
+    initCrashCapture();
+    last_crash_valid = getCrashRecord(&last_crash);
+    traceCrash(TRACE_BOOT);
+
+    init_TM4C_hardware();
+    traceCrash(TRACE_HARDWARE);
+
+    init_rtc_calibration(RTC_CAL_WINDOW, RTC_CAL_PERIOD, SYSTEM_CLK);
+
+    if (!(HIB_CTL_R & HIB_CTL_CLK32EN))     // Initialise hibernation module only once
+    {
+        init_hibernation_module();
+        traceCrash(TRACE_CALIBRATION);
+        start_rtc_calibration();            // Trim the RTC on first power up
+    }
+    init_energy_accounting();               // Account time spent in hibernation and the wake cause
+
+    if(EXT_WAKE)                            // Check if wake was caused by external button press
+    {
+        setPinValue(LED_RED, 0);
+        setPinValue(LED_GREEN, 0);
+        setPinValue(LED_BLUE, 1);
+    }
+    else if (RTC_WAKE)                      // Check if wake was caused by timeout of RTC module
+    {
+        setPinValue(LED_RED, 1);
+        setPinValue(LED_BLUE, 0);
+        setPinValue(LED_GREEN, 0);
+    }
+    else                                    // Cold boot
+    {
+        setPinValue(LED_RED, 1);
+    }
+
+    enable_gpio_retention(PORTF, LED_MASK);
+    traceCrash(TRACE_WAIT);
+    wait_for_button_press();
+
+    traceCrash(TRACE_HIBERNATE);
+    enter_energy_mode(MODE_HIBERNATE);      // Save running totals before RAM is lost
+    hibernate(5);
+    while(1)    {}
+}
@@ -15,6 +15,8 @@
 // Device includes, defines, and assembler directives
 //-----------------------------------------------------------------------------
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "nvic.h"
 #include "tm4c123gh6pm.h"
 
@@ -51,3 +53,82 @@ void setNvicInterruptPriority(uint8_t vectorNumber, uint8_t priority)
     *p &= ~(7 << shift);
     *p |= priority << shift;
 }
+
+void setNvicInterruptPending(uint8_t vectorNumber)
+{
+    volatile uint32_t* p = (uint32_t*) &NVIC_PEND0_R;
+    vectorNumber -= 16;
+    p += vectorNumber >> 5;
+    *p = 1 << (vectorNumber & 31);
+}
+
+void clearNvicInterruptPending(uint8_t vectorNumber)
+{
+    volatile uint32_t* p = (uint32_t*) &NVIC_UNPEND0_R;
+    vectorNumber -= 16;
+    p += vectorNumber >> 5;
+    *p = 1 << (vectorNumber & 31);
+}
+
+bool isNvicInterruptPending(uint8_t vectorNumber)
+{
+    volatile uint32_t* p = (uint32_t*) &NVIC_PEND0_R;
+    vectorNumber -= 16;
+    p += vectorNumber >> 5;
+    return (*p >> (vectorNumber & 31)) & 1;
+}
+
+bool isNvicInterruptActive(uint8_t vectorNumber)
+{
+    volatile uint32_t* p = (uint32_t*) &NVIC_ACTIVE0_R;
+    vectorNumber -= 16;
+    p += vectorNumber >> 5;
+    return (*p >> (vectorNumber & 31)) & 1;
+}
+
+// Split the 3 priority bits into preemption (group) and sub-priority bits
+// prigroup 0-4: 3 group bits, 5: 2 group + 1 sub, 6: 1 group + 2 sub, 7: 3 sub
+void setNvicPriorityGrouping(uint8_t prigroup)
+{
+    NVIC_APINT_R = NVIC_APINT_VECTKEY | ((prigroup << 8) & NVIC_APINT_PRIGROUP_M);
+}
+
+uint8_t getNvicPriorityGrouping(void)
+{
+    return (NVIC_APINT_R & NVIC_APINT_PRIGROUP_M) >> 8;
+}
+
+// BASEPRI access
+// BASEPRI holds the priority in bits 7:5 (priority << 5), 0 disables masking
+uint32_t getNvicBasePriority(void)
+{
+    __asm("    MRS  R0, BASEPRI\n"
+          "    BX   LR");
+    return 0;                                   // not reached, satisfies the compiler
+}
+
+void setNvicBasePriority(uint32_t basePriority)
+{
+    __asm("    MSR  BASEPRI, R0");
+}
+
+// Raises the masking level only, a lower level than the current one is ignored
+void raiseNvicBasePriority(uint32_t basePriority)
+{
+    __asm("    MSR  BASEPRI_MAX, R0");
+}
+
+// Nestable critical section that masks only interrupts with a priority of
+// priority (1-7) or lower urgency (numerically higher), so more urgent
+// interrupts keep running. Returns the state for leaveNvicCriticalSection()
+uint32_t enterNvicCriticalSection(uint8_t priority)
+{
+    uint32_t state = getNvicBasePriority();
+    raiseNvicBasePriority((priority & 7) << 5);
+    return state;
+}
+
+void leaveNvicCriticalSection(uint32_t state)
+{
+    setNvicBasePriority(state);
+}
@@ -31,7 +31,8 @@
 //*****************************************************************************
 void ResetISR(void);
 static void NmiSR(void);
-static void FaultISR(void);
+void FaultISR(void);                        // pure assembly, defined below
+void WatchdogISR(void);
 static void IntDefaultHandler(void);
 
 //*****************************************************************************
@@ -71,9 +72,9 @@ void (* const g_pfnVectors[])(void) =
     ResetISR,                               // The reset handler
     NmiSR,                                  // The NMI handler
     FaultISR,                               // The hard fault handler
-    IntDefaultHandler,                      // The MPU fault handler
-    IntDefaultHandler,                      // The bus fault handler
-    IntDefaultHandler,                      // The usage fault handler
+    FaultISR,                               // The MPU fault handler
+    FaultISR,                               // The bus fault handler
+    FaultISR,                               // The usage fault handler
     0,                                      // Reserved
     0,                                      // Reserved
     0,                                      // Reserved
@@ -101,7 +102,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // ADC Sequence 1
     IntDefaultHandler,                      // ADC Sequence 2
     IntDefaultHandler,                      // ADC Sequence 3
-    IntDefaultHandler,                      // Watchdog timer
+    WatchdogISR,                            // Watchdog timer
     IntDefaultHandler,                      // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
     IntDefaultHandler,                      // Timer 1 subtimer A
@@ -265,21 +266,49 @@ NmiSR(void)
 
 //*****************************************************************************
 //
-// This is the code that gets called when the processor receives a fault
-// interrupt.  This simply enters an infinite loop, preserving the system state
-// for examination by a debugger.
+// This is the code that gets called when the processor receives a hard, MPU,
+// bus or usage fault.  The exception frame of the faulting code is passed to
+// the crash capture handler, which records the fault and resets the device.
+//
+// The handler is written entirely in assembly: a C function may push
+// registers in its prologue before the inline assembly reads MSP, which would
+// hand the capture a frame shifted by the size of the push.  The stack that
+// was in use when the fault occurred is selected from EXC_RETURN bit 2.
 //
 //*****************************************************************************
-static void
-FaultISR(void)
-{
-    //
-    // Enter an infinite loop.
-    //
-    while(1)
-    {
-    }
-}
+__asm("    .sect   \".text:FaultISR\"\n"
+      "    .thumb\n"
+      "    .align  2\n"
+      "    .global FaultISR\n"
+      "    .global crashFaultHandler\n"
+      "FaultISR: .asmfunc\n"
+      "    tst     lr, #4\n"
+      "    ite     eq\n"
+      "    mrseq   r0, msp\n"
+      "    mrsne   r0, psp\n"
+      "    b.w     crashFaultHandler\n"
+      "    .endasmfunc");
+
+//*****************************************************************************
+//
+// This is the code that gets called on the first watchdog timeout.  The
+// exception frame of the interrupted code is passed to the watchdog
+// supervisor so a hang can be recorded before the second timeout resets the
+// device.  Pure assembly for the same reason as FaultISR.
+//
+//*****************************************************************************
+__asm("    .sect   \".text:WatchdogISR\"\n"
+      "    .thumb\n"
+      "    .align  2\n"
+      "    .global WatchdogISR\n"
+      "    .global watchdog0Isr\n"
+      "WatchdogISR: .asmfunc\n"
+      "    tst     lr, #4\n"
+      "    ite     eq\n"
+      "    mrseq   r0, msp\n"
+      "    mrsne   r0, psp\n"
+      "    b.w     watchdog0Isr\n"
+      "    .endasmfunc");
 
 //*****************************************************************************
 //
@@ -16,6 +16,21 @@
 #include "tm4c123gh6pm.h"
 #include "nvic.h"
 #include "wd0.h"
+#include "crash.h"
+
+// Bit-band alias of a bit in an SRAM variable, so check-ins are single atomic stores from any context
+#define SRAM_BITBAND(var, bit) (*((volatile uint32_t *)(0x22000000 + (((uintptr_t)&(var) - 0x20000000) * 32) + ((bit) * 4))))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t watchdogTimeoutUs;
+static volatile uint32_t requiredTasks;              // one bit per registered task
+static volatile uint32_t checkIns;                   // set by tasks, cleared by the supervisor
+static uint8_t taskDeadline[MAX_WATCHDOG_TASKS];     // in watchdog timeout periods
+static uint8_t taskAge[MAX_WATCHDOG_TASKS];          // periods since the last check-in
+static uint32_t missedTasks;
 
 //-----------------------------------------------------------------------------
 // Subroutines
@@ -30,10 +45,12 @@ void initWatchdog0(uint32_t timeoutUs, uint32_t fcyc)
     // Configure WDT0 which is driven by the system clock
     WATCHDOG0_LOCK_R = 0x1ACCE551;                       // unlock
     WATCHDOG0_LOAD_R = timeoutUs * (fcyc / 1e6);         // convert into fcyc units
+    watchdogTimeoutUs = timeoutUs;
     WATCHDOG0_CTL_R |= WDT_CTL_RESEN;                    // enable reset if timeout
     WATCHDOG0_CTL_R |= WDT_CTL_INTEN;                    // enable interrupts
     WATCHDOG0_LOCK_R = 0;                                // lock-out further changes
     WATCHDOG0_ICR_R = 0;                                 // clear any pending interrupt
+    setNvicInterruptPriority(INT_WATCHDOG, PRIORITY_CRITICAL); // never masked by critical sections
     enableNvicInterrupt(INT_WATCHDOG);                   // turn-on interrupt 34 (WATCHDOG)
 }
 
@@ -41,3 +58,82 @@ void resetWatchdog0()
 {
     WATCHDOG0_ICR_R = 0;                                 // clear any pending interrupt
 }
+
+// Register a task or ISR with the supervisor
+// The task must call checkInWatchdog0Task() at least once every deadlineUs
+// Returns the task number, or MAX_WATCHDOG_TASKS if no slots are left
+uint8_t registerWatchdog0Task(uint32_t deadlineUs)
+{
+    uint8_t task = 0;
+    uint32_t periods = (deadlineUs + watchdogTimeoutUs - 1) / watchdogTimeoutUs;
+    while (task < MAX_WATCHDOG_TASKS && (requiredTasks & (1u << task)))
+        task++;
+    if (task < MAX_WATCHDOG_TASKS)
+    {
+        taskDeadline[task] = (periods == 0) ? 1 : (periods > 255) ? 255 : periods;
+        taskAge[task] = 0;
+        SRAM_BITBAND(requiredTasks, task) = 1;
+    }
+    return task;
+}
+
+void unregisterWatchdog0Task(uint8_t task)
+{
+    if (task < MAX_WATCHDOG_TASKS)
+        SRAM_BITBAND(requiredTasks, task) = 0;
+}
+
+// Safe to call from any ISR or task
+void checkInWatchdog0Task(uint8_t task)
+{
+    SRAM_BITBAND(checkIns, task) = 1;
+}
+
+// Watchdog first-timeout interrupt, frame is the exception frame of the interrupted code
+// Feeds the watchdog only if every registered task has checked in within its deadline
+// Otherwise the hang is captured, the interrupt is left pending and the second timeout resets the device
+void watchdog0Isr(const uint32_t* frame)
+{
+    uint32_t seen = checkIns;
+    uint32_t missed = 0;
+    uint8_t task;
+    for (task = 0; task < MAX_WATCHDOG_TASKS; task++)
+    {
+        if (!(requiredTasks & (1u << task)))
+            continue;
+        if (seen & (1u << task))
+        {
+            SRAM_BITBAND(checkIns, task) = 0;        // only clear what was seen, later check-ins are kept
+            taskAge[task] = 0;
+        }
+        else if (++taskAge[task] >= taskDeadline[task])
+            missed |= 1u << task;
+    }
+    if (missed)
+    {
+        missedTasks = missed;
+        captureCrash(CRASH_WATCHDOG, frame, missed);
+        disableNvicInterrupt(INT_WATCHDOG);          // let the rest of the system run until the reset
+    }
+    else
+    {
+        traceCrash(CRASH_TRACE_WATCHDOG | seen);
+        WATCHDOG0_ICR_R = 0;                         // feed
+    }
+}
+
+// Tasks that missed their deadline in this session
+uint32_t getWatchdog0MissedTasks()
+{
+    return missedTasks;
+}
+
+// Tasks that missed their deadline before the last watchdog reset, 0 if none
+// Requires initCrashCapture() to have been called at boot
+uint32_t getWatchdog0ResetTasks()
+{
+    CRASH_RECORD record;
+    if ((SYSCTL_RESC_R & SYSCTL_RESC_WDT0) && getCrashRecord(&record) && record.cause == CRASH_WATCHDOG)
+        return record.detail;
+    return 0;
+}
@@ -11,6 +11,10 @@
 #ifndef WD0_H_
 #define WD0_H_
 
+#include <stdint.h>
+
+#define MAX_WATCHDOG_TASKS 32
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
@@ -18,4 +22,12 @@
 void initWatchdog0(uint32_t timeoutUs, uint32_t fcyc);
 void resetWatchdog0();
 
+// Supervisor: the watchdog is fed only while every registered task checks in on time
+uint8_t registerWatchdog0Task(uint32_t deadlineUs);
+void unregisterWatchdog0Task(uint8_t task);
+void checkInWatchdog0Task(uint8_t task);
+void watchdog0Isr(const uint32_t* frame);
+uint32_t getWatchdog0MissedTasks();
+uint32_t getWatchdog0ResetTasks();
+
 #endif
@@ -7,57 +7,111 @@ CMD_SRCS += \
 ../tm4c123gh6pm.cmd 
 
 C_SRCS += \
+../adc.c \
 ../clock.c \
 ../gpio.c \
+../itm.c \
+../latency.c \
+../ledpwm.c \
 ../main.c \
+../mcp23s08.c \
 ../nvic.c \
-../spi1.c \
+../spi.c \
+../spibus.c \
+../swspi.c \
 ../tm4c123gh6pm_startup_ccs.c \
+../uart0.c \
+../udma.c \
 ../wait.c 
 
 C_DEPS += \
+./adc.d \
 ./clock.d \
 ./gpio.d \
+./itm.d \
+./latency.d \
+./ledpwm.d \
 ./main.d \
+./mcp23s08.d \
 ./nvic.d \
-./spi1.d \
+./spi.d \
+./spibus.d \
+./swspi.d \
 ./tm4c123gh6pm_startup_ccs.d \
+./uart0.d \
+./udma.d \
 ./wait.d 
 
 OBJS += \
+./adc.obj \
 ./clock.obj \
 ./gpio.obj \
+./itm.obj \
+./latency.obj \
+./ledpwm.obj \
 ./main.obj \
+./mcp23s08.obj \
 ./nvic.obj \
-./spi1.obj \
+./spi.obj \
+./spibus.obj \
+./swspi.obj \
 ./tm4c123gh6pm_startup_ccs.obj \
+./uart0.obj \
+./udma.obj \
 ./wait.obj 
 
 OBJS__QUOTED += \
+"adc.obj" \
 "clock.obj" \
 "gpio.obj" \
+"itm.obj" \
+"latency.obj" \
+"ledpwm.obj" \
 "main.obj" \
+"mcp23s08.obj" \
 "nvic.obj" \
-"spi1.obj" \
+"spi.obj" \
+"spibus.obj" \
+"swspi.obj" \
 "tm4c123gh6pm_startup_ccs.obj" \
+"uart0.obj" \
+"udma.obj" \
 "wait.obj" 
 
 C_DEPS__QUOTED += \
+"adc.d" \
 "clock.d" \
 "gpio.d" \
+"itm.d" \
+"latency.d" \
+"ledpwm.d" \
 "main.d" \
+"mcp23s08.d" \
 "nvic.d" \
-"spi1.d" \
+"spi.d" \
+"spibus.d" \
+"swspi.d" \
 "tm4c123gh6pm_startup_ccs.d" \
+"uart0.d" \
+"udma.d" \
 "wait.d" 
 
 C_SRCS__QUOTED += \
+"../adc.c" \
 "../clock.c" \
 "../gpio.c" \
+"../itm.c" \
+"../latency.c" \
+"../ledpwm.c" \
 "../main.c" \
+"../mcp23s08.c" \
 "../nvic.c" \
-"../spi1.c" \
+"../spi.c" \
+"../spibus.c" \
+"../swspi.c" \
 "../tm4c123gh6pm_startup_ccs.c" \
+"../uart0.c" \
+"../udma.c" \
 "../wait.c" 
 
 
@@ -0,0 +1,265 @@
+// ADC Streaming Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Analog inputs:
+//   AIN0-3 on PE3-PE0, AIN4-7 on PD3-PD0, AIN8-9 on PE5-PE4, AIN10-11 on PB4-PB5
+// Sample clock:
+//   TIMER0A timeout triggers sample sequencer 0 of every started ADC
+
+// Each ADC converts a list of up to 8 channels per trigger in sequencer 0.
+// The end of the sequence raises a uDMA request that moves the whole sequence
+// into the active half of a ping-pong buffer, so the CPU is only involved once
+// per half buffer. Both ADCs share the TIMER0A trigger, which keeps their
+// sequences in lockstep for simultaneous channels.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "udma.h"
+#include "dwt.h"
+#include "adc.h"
+
+#define ADC_STRIDE          0x1000          // ADC1 registers follow ADC0
+#define ADC_REG(adc, reg)   (*((volatile uint32_t *)((uintptr_t)&(reg) + (adc) * ADC_STRIDE)))
+
+#define AIN_CHANNELS        12
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _ADC_PIN
+{
+    PORT port;
+    uint8_t pin;
+} ADC_PIN;
+
+static const ADC_PIN ainPins[AIN_CHANNELS] =
+{
+    {PORTE, 3}, {PORTE, 2}, {PORTE, 1}, {PORTE, 0},
+    {PORTD, 3}, {PORTD, 2}, {PORTD, 1}, {PORTD, 0},
+    {PORTE, 5}, {PORTE, 4}, {PORTB, 4}, {PORTB, 5}
+};
+
+static const uint8_t dmaChannel[ADC_COUNT] = {14, 24};
+static const uint8_t dmaEncoding[ADC_COUNT] = {UDMA_CH14_ADC0SS0, UDMA_CH24_ADC1SS0};
+static const uint8_t ss0Vector[ADC_COUNT] = {INT_ADC0SS0, INT_ADC1SS0};
+
+typedef struct _ADC_STREAM
+{
+    uint8_t steps;
+    bool started;
+    uint16_t* buffer[2];
+    uint16_t count;
+    ADC_CALLBACK callback;
+    uint32_t lastCycles;
+    ADC_STATS stats;
+} ADC_STREAM;
+
+static ADC_STREAM streams[ADC_COUNT];
+static bool sampling;                       // TIMER0A is triggering sequences
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Configures sequencer 0 of an ADC to convert steps channels per trigger
+// steps must be 1, 2, 4 or 8 so a whole sequence is one uDMA arbitration burst
+// oversampleLog2 averages 2^n conversions per sample in hardware (0 to 6),
+// which divides the achievable sample rate by the same factor
+void initAdc(uint8_t adc, const uint8_t channels[], uint8_t steps, uint8_t oversampleLog2)
+{
+    uint32_t mux = 0;
+    uint8_t i;
+
+    // Enable clocks
+    SYSCTL_RCGCADC_R |= adc ? SYSCTL_RCGCADC_R1 : SYSCTL_RCGCADC_R0;
+    _delay_cycles(16);
+
+    for (i = 0; i < steps; i++)
+    {
+        enablePort(ainPins[channels[i]].port);
+        selectPinAnalogInput(ainPins[channels[i]].port, ainPins[channels[i]].pin);
+        mux |= (uint32_t)channels[i] << (i * 4);
+    }
+
+    ADC_REG(adc, ADC0_ACTSS_R) &= ~ADC_ACTSS_ASEN0;               // disable SS0 while configuring
+    ADC_REG(adc, ADC0_PC_R) = ADC_PC_SR_1M;
+    ADC_REG(adc, ADC0_CTL_R) = 0;                                  // VDDA/GNDA reference
+    ADC_REG(adc, ADC0_SAC_R) = oversampleLog2 & ADC_SAC_AVG_M;
+    ADC_REG(adc, ADC0_EMUX_R) = (ADC_REG(adc, ADC0_EMUX_R) & ~ADC_EMUX_EM0_M) | ADC_EMUX_EM0_TIMER;
+    ADC_REG(adc, ADC0_SSMUX0_R) = mux;
+    ADC_REG(adc, ADC0_SSCTL0_R) = (ADC_SSCTL0_END0 | ADC_SSCTL0_IE0) << ((steps - 1) * 4);
+    ADC_REG(adc, ADC0_IM_R) &= ~ADC_IM_MASK0;                      // the ISR runs on uDMA completion only
+    ADC_REG(adc, ADC0_ISC_R) = ADC_ISC_IN0;
+
+    streams[adc].steps = steps;
+    streams[adc].started = false;
+}
+
+// uDMA completion of one half buffer
+static void adcDmaComplete(uint8_t channel, bool alternate)
+{
+    uint8_t adc = channel == dmaChannel[ADC0] ? ADC0 : ADC1;
+    ADC_STREAM* stream = &streams[adc];
+    stream->stats.samples += stream->count;
+    stream->stats.halves++;
+    if (stream->callback)
+        stream->callback(adc, stream->buffer[alternate], stream->count);
+}
+
+// Routes sample sequencer 0 of an ADC into ping and pong, count samples each
+// count must be a multiple of the step count and at most UDMA_MAX_TRANSFER
+// Returns false if the uDMA channel is in use
+bool startAdcStream(uint8_t adc, uint16_t* ping, uint16_t* pong, uint16_t count,
+                    ADC_CALLBACK callback)
+{
+    ADC_STREAM* stream = &streams[adc];
+    uint8_t arbLog2 = 0;
+
+    if (!stream->started && !allocateUdmaChannel(dmaChannel[adc], dmaEncoding[adc], adcDmaComplete))
+        return false;
+    while ((1 << arbLog2) < stream->steps)
+        arbLog2++;
+
+    stream->buffer[0] = ping;
+    stream->buffer[1] = pong;
+    stream->count = count;
+    stream->callback = callback;
+    stream->started = true;
+    clearAdcStats(adc);
+
+    startUdmaPingPong(dmaChannel[adc], &ADC_REG(adc, ADC0_SSFIFO0_R), ping, pong,
+                      UDMA_SIZE_16, arbLog2, count);
+    ADC_REG(adc, ADC0_ACTSS_R) |= ADC_ACTSS_ASEN0;
+    setNvicInterruptPriority(ss0Vector[adc], PRIORITY_BUS);
+    enableNvicInterrupt(ss0Vector[adc]);
+    return true;
+}
+
+// Starts TIMER0A, each timeout triggers one sequence on every started ADC
+// sequenceRate is in sequences per second, so the conversion rate of an ADC is
+// sequenceRate * steps and must stay at or below ADC_MAX_RATE
+void startAdcSampling(uint32_t sequenceRate, uint32_t fcyc)
+{
+    uint8_t adc;
+
+    initCycleCounter();
+    for (adc = 0; adc < ADC_COUNT; adc++)
+        streams[adc].lastCycles = DWT_CYCCNT_R;
+    sampling = true;
+
+    // Enable clocks
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0;
+    _delay_cycles(3);
+
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off timer before reconfiguring
+    TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;          // configure as 32-bit timer (A+B)
+    TIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD;         // configure for periodic mode (count down)
+    TIMER0_TAILR_R = fcyc / sequenceRate - 1;
+    TIMER0_IMR_R = 0;                               // the trigger does not need the interrupt
+    TIMER0_CTL_R |= TIMER_CTL_TAOTE | TIMER_CTL_TAEN;
+}
+
+// Accounts elapsed time, from every half buffer ISR and before the stats are
+// read, so the 32-bit cycle counter is sampled well within its 107 s wrap at
+// 40 MHz however rarely the stats are read
+static void updateElapsed(ADC_STREAM* stream)
+{
+    uint32_t now = DWT_CYCCNT_R;
+    if (sampling)
+        stream->stats.elapsedCycles += now - stream->lastCycles;
+    stream->lastCycles = now;
+}
+
+// The elapsed time stops with the trigger, so time spent stopped (when no ISR
+// samples the cycle counter) is not counted
+void stopAdcSampling(void)
+{
+    uint32_t state = enterNvicCriticalSection(PRIORITY_BUS);
+    uint8_t adc;
+
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;
+    for (adc = 0; adc < ADC_COUNT; adc++)
+        updateElapsed(&streams[adc]);
+    sampling = false;
+    leaveNvicCriticalSection(state);
+}
+
+void getAdcStats(uint8_t adc, ADC_STATS* stats)
+{
+    uint32_t state = enterNvicCriticalSection(PRIORITY_BUS);
+    updateElapsed(&streams[adc]);
+    *stats = streams[adc].stats;
+    leaveNvicCriticalSection(state);
+}
+
+void clearAdcStats(uint8_t adc)
+{
+    uint32_t state = enterNvicCriticalSection(PRIORITY_BUS);
+    streams[adc].stats.samples = 0;
+    streams[adc].stats.halves = 0;
+    streams[adc].stats.overruns = 0;
+    streams[adc].stats.elapsedCycles = 0;
+    streams[adc].stats.isrCycles = 0;
+    streams[adc].lastCycles = DWT_CYCCNT_R;
+    leaveNvicCriticalSection(state);
+}
+
+// Delivered samples per second since the stats were cleared
+uint32_t getAdcThroughput(uint8_t adc, uint32_t fcyc)
+{
+    ADC_STATS stats;
+    getAdcStats(adc, &stats);
+    if (stats.elapsedCycles == 0)
+        return 0;
+    return ((uint64_t)stats.samples * fcyc) / stats.elapsedCycles;
+}
+
+// CPU time spent servicing the stream, in units of 0.1 %
+uint16_t getAdcCpuLoad(uint8_t adc)
+{
+    ADC_STATS stats;
+    getAdcStats(adc, &stats);
+    if (stats.elapsedCycles == 0)
+        return 0;
+    return (stats.isrCycles * 1000) / stats.elapsedCycles;
+}
+
+static void serviceAdc(uint8_t adc)
+{
+    ADC_STREAM* stream = &streams[adc];
+    uint32_t start = DWT_CYCCNT_R;
+    uint32_t halves = stream->stats.halves;
+    ADC_REG(adc, ADC0_ISC_R) = ADC_ISC_IN0;
+    serviceUdmaCompletions(1 << dmaChannel[adc]);
+    if (stream->stats.halves - halves > 1)
+        stream->stats.overruns++;
+    updateElapsed(stream);
+    stream->stats.isrCycles += DWT_CYCCNT_R - start;
+}
+
+void adc0Ss0Isr(void)
+{
+    serviceAdc(ADC0);
+}
+
+void adc1Ss0Isr(void)
+{
+    serviceAdc(ADC1);
+}
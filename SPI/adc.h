@@ -0,0 +1,65 @@
+// ADC Streaming Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Analog inputs:
+//   AIN0-3 on PE3-PE0, AIN4-7 on PD3-PD0, AIN8-9 on PE5-PE4, AIN10-11 on PB4-PB5
+//   PD0-PD3 and PE1 are taken by SSI1 and the expander INT in this project
+// Sample clock:
+//   TIMER0A timeout triggers sample sequencer 0 of every started ADC
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC0                0
+#define ADC1                1
+#define ADC_COUNT           2
+#define ADC_MAX_STEPS       8               // sample sequencer 0 depth
+#define ADC_MAX_RATE        1000000         // conversions per second per ADC
+
+// Called once per filled half buffer, from the ADC sequence 0 ISR
+typedef void (*ADC_CALLBACK)(uint8_t adc, const uint16_t* samples, uint16_t count);
+
+typedef struct _ADC_STATS
+{
+    uint32_t samples;                       // samples delivered to the callback
+    uint32_t halves;                        // half buffers delivered
+    uint32_t overruns;                      // both halves filled before the ISR ran
+    uint64_t elapsedCycles;                 // while sampling, since the stats were cleared
+    uint64_t isrCycles;                     // spent in the ISR and callback
+} ADC_STATS;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initAdc(uint8_t adc, const uint8_t channels[], uint8_t steps, uint8_t oversampleLog2);
+bool startAdcStream(uint8_t adc, uint16_t* ping, uint16_t* pong, uint16_t count,
+                    ADC_CALLBACK callback);
+void startAdcSampling(uint32_t sequenceRate, uint32_t fcyc);
+void stopAdcSampling(void);
+
+void getAdcStats(uint8_t adc, ADC_STATS* stats);
+void clearAdcStats(uint8_t adc);
+uint32_t getAdcThroughput(uint8_t adc, uint32_t fcyc);
+uint16_t getAdcCpuLoad(uint8_t adc);
+
+void adc0Ss0Isr(void);
+void adc1Ss0Isr(void);
+
+#endif
@@ -0,0 +1,56 @@
+// ITM Trace Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// SWO on PC3 (TDO/SWO), captured by the debug probe in SWD mode
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "dwt.h"
+#include "itm.h"
+
+#define ITM_LAR_KEY         0xC5ACCE55
+#define ITM_TCR_ITMENA      0x00000001
+#define ITM_TCR_SYNCENA     0x00000004
+#define ITM_TCR_TXENA       0x00000008
+#define ITM_TCR_BUSID_S     16
+
+#define TPIU_ACPR_R         (*((volatile uint32_t *)0xE0040010))
+#define TPIU_SPPR_R         (*((volatile uint32_t *)0xE00400F0))
+#define TPIU_FFCR_R         (*((volatile uint32_t *)0xE0040304))
+#define TPIU_SPPR_NRZ       0x00000002      // SWO in UART (NRZ) encoding
+#define TPIU_FFCR_TRIGIN    0x00000100      // formatter bypassed, trigger kept
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Route ITM to SWO at swoBaud and enable the event ports
+// Ports can be switched on and off at runtime through ITM_TER_R
+void initItm(uint32_t swoBaud, uint32_t fcyc)
+{
+    initCycleCounter();                                  // also sets TRCENA
+
+    TPIU_SPPR_R = TPIU_SPPR_NRZ;
+    TPIU_ACPR_R = (fcyc / swoBaud) - 1;
+    TPIU_FFCR_R = TPIU_FFCR_TRIGIN;
+
+    ITM_LAR_R = ITM_LAR_KEY;                             // unlock
+    ITM_TCR_R = (1 << ITM_TCR_BUSID_S) | ITM_TCR_TXENA | ITM_TCR_SYNCENA | ITM_TCR_ITMENA;
+    ITM_TER_R = (1 << ITM_PORT_TEXT)
+              | (1 << ITM_PORT_SPI_START) | (1 << ITM_PORT_SPI_STOP)
+              | (1 << ITM_PORT_I2C_START) | (1 << ITM_PORT_I2C_STOP)
+              | (0xFF << ITM_PORT_ISR_ENTER) | (0xFF << ITM_PORT_ISR_EXIT);
+}
@@ -0,0 +1,139 @@
+// Interrupt Latency Harness
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// Expander INT line looped back to PC4 (WT0CCP0) for edge capture
+
+// WTIMER0A free runs at the system clock in edge-time mode and latches the
+// falling INT edge. On ISR entry the captured edge is translated into the DWT
+// cycle counter time base, and every later stage is measured against it.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "latency.h"
+#include "dwt.h"
+
+// Pins
+#define CAPTURE PORTC,4
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static LATENCY_STATS stats[LATENCY_STAGES];
+static uint8_t shift;
+static uint32_t edge;                       // INT edge in DWT cycles
+static bool eventValid;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint32_t getCycleCount(void)
+{
+    return DWT_CYCCNT_R;
+}
+
+// binShift sets the histogram bin width to 2^binShift cycles
+void initLatencyHarness(uint8_t binShift)
+{
+    shift = binShift;
+    clearLatencyStats();
+
+    initCycleCounter();
+
+    // Enable clocks
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R0;
+    _delay_cycles(3);
+    enablePort(PORTC);
+    selectPinDigitalInput(CAPTURE);
+    setPinAuxFunction(CAPTURE, GPIO_PCTL_PC4_WT0CCP0);
+
+    // Configure WTIMER0A as a free running 32-bit edge timer on falling edges
+    WTIMER0_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off timer before reconfiguring
+    WTIMER0_CFG_R = TIMER_CFG_16_BIT;                // 32-bit timer A (individual)
+    WTIMER0_TAMR_R = TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACMR | TIMER_TAMR_TACDIR;
+    WTIMER0_CTL_R = TIMER_CTL_TAEVENT_NEG;
+    WTIMER0_TAILR_R = 0xFFFFFFFF;
+    WTIMER0_ICR_R = TIMER_ICR_CAECINT;
+    WTIMER0_CTL_R |= TIMER_CTL_TAEN;                 // turn-on timer
+}
+
+void clearLatencyStats(void)
+{
+    uint8_t i, j;
+    for (i = 0; i < LATENCY_STAGES; i++)
+    {
+        stats[i].count = 0;
+        stats[i].min = 0xFFFFFFFF;
+        stats[i].max = 0;
+        stats[i].sum = 0;
+        for (j = 0; j < LATENCY_BINS; j++)
+            stats[i].bins[j] = 0;
+    }
+}
+
+static void recordLatency(uint8_t stage, uint32_t cycles)
+{
+    LATENCY_STATS* s = &stats[stage];
+    uint32_t bin = cycles >> shift;
+    if (bin >= LATENCY_BINS)
+        bin = LATENCY_BINS - 1;
+    s->bins[bin]++;
+    s->count++;
+    s->sum += cycles;
+    if (cycles < s->min)
+        s->min = cycles;
+    if (cycles > s->max)
+        s->max = cycles;
+}
+
+// Call first thing in the ISR
+// Returns false if no edge was captured, the event is then not recorded
+bool startLatencyEvent(void)
+{
+    uint32_t now = DWT_CYCCNT_R;
+    uint32_t timer = WTIMER0_TAV_R;
+    eventValid = WTIMER0_RIS_R & TIMER_RIS_CAERIS;
+    if (eventValid)
+    {
+        edge = now - (timer - WTIMER0_TAR_R);        // both counters run at the system clock
+        WTIMER0_ICR_R = TIMER_ICR_CAECINT;
+        recordLatency(LATENCY_ISR_ENTRY, now - edge);
+    }
+    return eventValid;
+}
+
+// Call when a stage of the current event completes
+void markLatency(uint8_t stage)
+{
+    if (eventValid && stage < LATENCY_STAGES)
+        recordLatency(stage, DWT_CYCCNT_R - edge);
+}
+
+void getLatencyStats(uint8_t stage, LATENCY_STATS* s)
+{
+    if (stage < LATENCY_STAGES)
+        *s = stats[stage];
+}
+
+uint32_t getLatencyAverage(uint8_t stage)
+{
+    if (stage >= LATENCY_STAGES || stats[stage].count == 0)
+        return 0;
+    return stats[stage].sum / stats[stage].count;
+}
@@ -0,0 +1,286 @@
+// Expander LED PWM Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// MCP23S08 on SPI1 with ~CS on PD1 (SSI1Fss), GP0-GP6 outputs
+// TIMER2A paces uDMA channel 4 into the SSI1 TX FIFO
+
+// With IOCON.SEQOP set the expander no longer advances its address pointer,
+// so after one opcode and GPIO address every further byte clocked in while
+// ~CS stays low is latched straight into the GPIO register. A frame table
+// holds one GPIO value per PWM slot (2^bits slots per refresh). Every TIMER2A
+// timeout the uDMA moves the next slot into SSI1, so a refresh costs the CPU
+// two ping-pong re-arms regardless of the PWM resolution.
+// Level changes are built into the back table from the main loop and swapped
+// in at the next half buffer boundary. Other expander accesses bracket their
+// transaction with pauseLedPwm()/resumeLedPwm(), which end and restart the
+// streaming transaction.
+// The expander is owned by mcp23s08.c: IOCON goes through its register
+// shadow and the stream opcode comes from the device address it was given.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "spi.h"
+#include "udma.h"
+#include "mcp23s08.h"
+#include "ledpwm.h"
+
+#define EXPANDER_SPI SPI1
+
+#define PWM_CHANNEL         4               // uDMA channel for TIMER2A
+#define MAX_SLOTS           (1 << LED_PWM_MAX_BITS)
+#define LEVEL_FRACTION      8               // fade levels are kept in 8.8 fixed point
+#define BOTH_HALVES         3
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _LED_FADE
+{
+    int32_t level;                          // current level, 8.8 fixed point
+    int32_t step;                           // change per refresh, 8.8 fixed point
+    uint16_t target;                        // level reached when the fade ends
+    uint16_t remaining;                     // refreshes left in the fade
+} LED_FADE;
+
+static uint8_t tables[2][MAX_SLOTS];
+static volatile uint8_t front;              // table the uDMA is pointed at
+static volatile uint8_t armedHalves;        // halves re-pointed at the front table
+static uint16_t slots;
+static uint16_t levels[LED_PWM_PINS];
+static LED_FADE fades[LED_PWM_PINS];
+static bool dirty;
+static bool running;
+static uint8_t pauseDepth;
+static uint32_t control;
+static uint8_t opcode;                      // MCP23S08 write opcode of the LED expander
+static volatile uint32_t* dataRegister;     // SSI data register fed by the uDMA
+static volatile uint32_t refreshCount;
+static uint32_t lastRefresh;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Lowers ~CS and addresses the GPIO register for the streaming transaction
+// The timer paces bytes slower than the FIFO drains, so ~CS is held by GPIO
+static void openStream(void)
+{
+    setSpiDataSize(EXPANDER_SPI, 8);       // uDMA moves one byte per slot
+    selectSpiFss(EXPANDER_SPI);
+    writeSpiData(EXPANDER_SPI, opcode);
+    writeSpiData(EXPANDER_SPI, MCP23S08_GPIO);
+    TIMER2_CTL_R |= TIMER_CTL_TAEN;
+}
+
+static void closeStream(void)
+{
+    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+    while (isSpiBusy(EXPANDER_SPI));
+    deselectSpiFss(EXPANDER_SPI);
+    drainSpiRx(EXPANDER_SPI);              // discard bytes clocked in while streaming
+}
+
+static void buildTable(uint8_t* table)
+{
+    uint16_t slot;
+    uint8_t pin;
+    for (slot = 0; slot < slots; slot++)
+        table[slot] = 0;
+    for (pin = 0; pin < LED_PWM_PINS; pin++)
+        for (slot = 0; slot < levels[pin]; slot++)
+            table[slot] |= 1 << pin;
+}
+
+// uDMA completion of one half refresh, the structure has already been re-armed
+static void pwmDmaComplete(uint8_t channel, bool alternate)
+{
+    uint16_t half = slots / 2;
+    setupUdmaTransfer(channel, alternate, &tables[front][alternate ? half : 0], dataRegister, control);
+    armedHalves |= 1 << alternate;
+    if (alternate)
+        refreshCount++;
+}
+
+// Configures the frame table for bits of resolution (1 to LED_PWM_MAX_BITS)
+// device is the hardware address of an expander set up with initMcp23s08()
+// refreshRate << bits bytes per second must fit the SPI baud rate (8 bit
+// times each), e.g. 8-bit PWM at 400 Hz needs 102400 bytes/s of a 2 MHz bus
+// Returns false if the uDMA channel is in use or the IOCON write failed
+bool initLedPwm(uint8_t device, uint8_t bits, uint32_t refreshRate, uint32_t fcyc)
+{
+    uint8_t pin;
+
+    if (!writeMcp23s08Register(device, MCP23S08_IOCON,
+                               getMcp23s08Register(device, MCP23S08_IOCON) | MCP23S08_IOCON_SEQOP))
+        return false;
+    if (!allocateUdmaChannel(PWM_CHANNEL, UDMA_CH4_TIMER2A, pwmDmaComplete))
+        return false;
+    opcode = getMcp23s08WriteOpcode(device);
+    slots = 1 << bits;
+    dataRegister = getSpiDataRegister(EXPANDER_SPI);
+    for (pin = 0; pin < LED_PWM_PINS; pin++)
+    {
+        levels[pin] = 0;
+        fades[pin].remaining = 0;
+    }
+    buildTable(tables[0]);
+    front = 0;
+    armedHalves = BOTH_HALVES;
+    dirty = false;
+    running = false;
+    pauseDepth = 0;
+    refreshCount = 0;
+    lastRefresh = 0;
+    control = makeUdmaControl(UDMA_MODE_PINGPONG, UDMA_SIZE_8, UDMA_INC_ITEM, UDMA_INC_NONE, 0, slots / 2);
+
+    // Enable clocks
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+    _delay_cycles(3);
+
+    // Configure Timer 2 as the slot clock, each timeout requests one uDMA transfer
+    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
+    TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
+    TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;          // configure for periodic mode (count down)
+    TIMER2_TAILR_R = fcyc / (refreshRate << bits) - 1;
+    TIMER2_IMR_R = 0;                                // only the uDMA done signal interrupts
+    setNvicInterruptPriority(INT_TIMER2A, PRIORITY_BUS);
+    enableNvicInterrupt(INT_TIMER2A);
+    return true;
+}
+
+void startLedPwm(void)
+{
+    startUdmaPingPongTx(PWM_CHANNEL, &tables[front][0], &tables[front][slots / 2], dataRegister,
+                        UDMA_SIZE_8, 0, slots / 2);
+    armedHalves = BOTH_HALVES;
+    running = true;
+    if (pauseDepth == 0)
+        openStream();
+}
+
+void stopLedPwm(void)
+{
+    if (running && pauseDepth == 0)
+        closeStream();
+    disableUdmaChannel(PWM_CHANNEL);
+    running = false;
+}
+
+// Ends the streaming transaction so another expander access can use the bus
+// Calls nest and are safe from ISRs below PRIORITY_BUS
+void pauseLedPwm(void)
+{
+    uint32_t state = enterNvicCriticalSection(PRIORITY_BUS);
+    if (pauseDepth++ == 0 && running)
+        closeStream();
+    leaveNvicCriticalSection(state);
+}
+
+void resumeLedPwm(void)
+{
+    uint32_t state = enterNvicCriticalSection(PRIORITY_BUS);
+    if (--pauseDepth == 0 && running)
+        openStream();
+    leaveNvicCriticalSection(state);
+}
+
+// Sets the on time of a pin in slots, 0 (off) to 2^bits (always on)
+void setLedPwmLevel(uint8_t pin, uint16_t level)
+{
+    if (level > slots)
+        level = slots;
+    fades[pin].remaining = 0;
+    levels[pin] = level;
+    dirty = true;
+}
+
+// Ramps a pin linearly to level over the given number of refreshes
+void setLedPwmFade(uint8_t pin, uint16_t level, uint16_t refreshes)
+{
+    if (level > slots)
+        level = slots;
+    if (refreshes == 0)
+    {
+        setLedPwmLevel(pin, level);
+        return;
+    }
+    fades[pin].level = (int32_t)levels[pin] << LEVEL_FRACTION;
+    fades[pin].step = (((int32_t)level << LEVEL_FRACTION) - fades[pin].level) / refreshes;
+    fades[pin].target = level;
+    fades[pin].remaining = refreshes;
+}
+
+// Sets every pin in mask to level and turns the others off
+void setLedPwmPattern(uint8_t mask, uint16_t level)
+{
+    uint8_t pin;
+    for (pin = 0; pin < LED_PWM_PINS; pin++)
+        setLedPwmLevel(pin, (mask & (1 << pin)) ? level : 0);
+}
+
+// Advances fades and publishes level changes, call from the main loop
+// A new table is built only once the uDMA no longer reads the back table
+void updateLedPwm(void)
+{
+    uint32_t refreshes = refreshCount - lastRefresh;
+    uint8_t pin;
+
+    for (pin = 0; pin < LED_PWM_PINS; pin++)
+    {
+        LED_FADE* fade = &fades[pin];
+        if (fade->remaining == 0 || refreshes == 0)
+            continue;
+        if (refreshes >= fade->remaining)
+        {
+            levels[pin] = fade->target;
+            fade->remaining = 0;
+        }
+        else
+        {
+            fade->level += fade->step * (int32_t)refreshes;
+            fade->remaining -= refreshes;
+            levels[pin] = fade->level >> LEVEL_FRACTION;
+        }
+        dirty = true;
+    }
+    lastRefresh += refreshes;
+
+    if (dirty && armedHalves == BOTH_HALVES)
+    {
+        uint32_t state;
+        dirty = false;                               // levels may change again while building
+        buildTable(tables[front ^ 1]);
+        state = enterNvicCriticalSection(PRIORITY_BUS);
+        front ^= 1;
+        armedHalves = 0;
+        leaveNvicCriticalSection(state);
+    }
+}
+
+uint32_t getLedPwmRefreshCount(void)
+{
+    return refreshCount;
+}
+
+// The uDMA done signal for channel 4 arrives on the TIMER2A vector
+void timer2aIsr(void)
+{
+    serviceUdmaCompletions(1 << PWM_CHANNEL);
+}
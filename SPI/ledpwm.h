@@ -0,0 +1,47 @@
+// Expander LED PWM Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// MCP23S08 on SPI1 with ~CS on PD1 (SSI1Fss), GP0-GP6 outputs
+// TIMER2A paces uDMA channel 4 into the SSI1 TX FIFO
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef LEDPWM_H_
+#define LEDPWM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LED_PWM_PINS        7               // GP0-GP6, GP7 is the push button input
+#define LED_PWM_MAX_BITS    8               // 256 slots per refresh
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool initLedPwm(uint8_t device, uint8_t bits, uint32_t refreshRate, uint32_t fcyc);
+void startLedPwm(void);
+void stopLedPwm(void);
+void pauseLedPwm(void);
+void resumeLedPwm(void);
+
+void setLedPwmLevel(uint8_t pin, uint16_t level);
+void setLedPwmFade(uint8_t pin, uint16_t level, uint16_t refreshes);
+void setLedPwmPattern(uint8_t mask, uint16_t level);
+void updateLedPwm(void);
+uint32_t getLedPwmRefreshCount(void);
+
+void timer2aIsr(void);
+
+#endif
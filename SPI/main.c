@@ -8,24 +8,35 @@
 #include "gpio.h"
 #include "clock.h"
 #include "nvic.h"
-#include "spi1.h"
+#include "spi.h"
+#include "spibus.h"
+#include "mcp23s08.h"
 #include "wait.h"
+#include "../common/ring.h"
+#include "latency.h"
+#include "uart0.h"
+#include "itm.h"
+#include "udma.h"
+#include "ledpwm.h"
 
 // TM4C Pins
 #define PIN_TM4C_SSI1_A1            PORTD,6     // A1   * Hard-wired in circuit
-#define PIN_TM4C_SSI1_A0            PORTD,5     // A0   * Hard-wired in circuit
+#define PIN_TM4C_SSI1_A0            PORTD,5     // A0   * Hard-wired in circuit (A1:A0 = 3, opcode 0x46/0x47)
 #define PIN_TM4C_SSI1_TX            PORTD,3     // SPI 1 Tx
 #define PIN_TM4C_SSI1_RX            PORTD,2     // SPI 1 Rx
-#define PIN_TM4C_PORTD_CHIP_SELECT  PORTD,1     // IO expander chip select
+#define PIN_TM4C_PORTD_CHIP_SELECT  PORTD,1     // IO expander chip select (SSI1Fss)
 #define PIN_TM4C_PORTD_SSI1_CLOCK   PORTD,0     // SPI 1 Clock
 #define PIN_TM4C_PORTE_INT          PORTE,1     // SPI interrupt
 
+// TM4C SSI module wired to the expander
+#define EXPANDER_SPI                SPI1
+#define EXPANDER_LED                3           // Hardware address of the LED and button expander
+#define EXPANDER_DEVICES            (1 << EXPANDER_LED) // MCP23S08s sharing the chip select (up to 4)
+
 // TM4C special values
 #define PORT_E_INTERRUPT_VECTOR     20          // Interrupt vector number for PORT E
 
-// MCP23S08 Opcodes
-#define OPCODE_MCP23S08_READ        0x47        // Opcode for reading values over SPI
-#define OPCODE_MCP23S08_WRIT        0x46        // Opcode for writing values over SPI
+// MCP23S08 Values
 #define VAL_MCP23S08_IODIR          0x80        // Value to set pin directions (bit 7 = input)
 #define VAL_MCP23S08_GPINTEN        0x80        // Value to Enable GPIO input pin for interrupt-on-change even
 #define VAL_MCP23S08_INTCON         0x80        // Value to indicate interrupt must be triggered on comparison to DEFVAL
@@ -40,20 +51,45 @@
 #define PIN_MCP23S08_INTCAP         0x08        // Register address to read interrupt capture values
 #define PIN_MCP23S08_GPIO           0x09        // Register address to access GPIO bits
 
+// MCP23S08 LEDs
+#define LED_MASK_INDICATOR          0x40        // LED left on between button presses
+#define LED_PIN_INDICATOR           6
+
+// Log record ids
+#define LOG_ID_PORTE_ISR            1           // arg = GPIO value read on entry
+#define LOG_ID_INTCAP               2           // arg = interrupt capture value
+#define LOG_ID_BUTTON               3           // arg = button press count
+
 // Misc Values
 #define LOGIC_LOW                   0
 #define LOGIC_HIGH                  1
 #define SYSTEM_CLK                  40e6        // System clock is configured for 40MHz operation
 #define SPI_BAUD                    2e6         // SPI bus baud rate
+#define SPI_FRAME_BITS              12          // Opcode, address and data fit two 12-bit frames
+#define SWO_BAUD                    2000000     // ITM trace rate on SWO
+#define LOG_BAUD                    115200      // UART0 log baud rate
+#define LATENCY_BIN_SHIFT           7           // 128 cycle (3.2us) latency histogram bins
+#define INTCAP_RING_SIZE            16          // Interrupt captures buffered for the main loop (power of 2)
+#define LED_PWM_BITS                6           // 64 brightness levels
+#define LED_PWM_REFRESH             400         // Hz, 25600 SPI bytes/s
+#define LED_LEVEL_FULL              (1 << LED_PWM_BITS)
+#define LED_LEVEL_DIM               4           // Idle indicator level
+#define LED_FADE_REFRESHES          LED_PWM_REFRESH // 1 s fade after a button press
+
+RING_BUFFER intcap_ring;                        // Interrupt captures passed from PORTE_ISR to main
+uint8_t intcap_data[INTCAP_RING_SIZE];
+uint32_t button_presses;
 
 /**
 *      @brief Function to initialize SPI lines
 **/
 void initialise_spi_bus(void)
 {
-      initSpi1(USE_SSI_RX);
-      setSpi1BaudRate(SPI_BAUD, SYSTEM_CLK);
-      setSpi1Mode(LOGIC_HIGH, LOGIC_HIGH);
+      initSpi(EXPANDER_SPI, USE_SSI_RX | USE_SSI_FSS); // Chip select framed by the SSI
+      setSpiBaudRate(EXPANDER_SPI, SPI_BAUD, SYSTEM_CLK);
+      setSpiMode(EXPANDER_SPI, LOGIC_HIGH, LOGIC_HIGH);
+      initSpiBus(SYSTEM_CLK);                         // Serialize main and ISR expander accesses
+      initMcp23s08(EXPANDER_SPI, SPI_BAUD, SPI_FRAME_BITS, PORTD, SPI_BUS_FSS, EXPANDER_DEVICES); // Hardware addressed expanders on the FSS chip select
 }
 
 /**
@@ -65,9 +101,14 @@ void init_TM4C_hardware(void)
 
       enablePort(PORTE);                              // Initialize clocks on PORTE
 
+      initUdma();                                     // DMA before any driver claims a channel
       initialise_spi_bus();                           // Initialize SPI bus
+      initLatencyHarness(LATENCY_BIN_SHIFT);          // Time INT edge to ISR and bus completion
+      initUart0Log(LOG_BAUD, SYSTEM_CLK);             // Binary event log on the ICDI virtual COM port
+      initItm(SWO_BAUD, SYSTEM_CLK);                  // Cycle stamped ISR and SPI frame trace
 
       enableNvicInterrupt(PORT_E_INTERRUPT_VECTOR);   // Initialize interrupt controller
+      setNvicInterruptPriority(PORT_E_INTERRUPT_VECTOR, PRIORITY_GPIO);
       disablePinInterrupt(PIN_TM4C_PORTE_INT);        // Disable Interrupt on PE01 to configure
       selectPinDigitalInput(PIN_TM4C_PORTE_INT);      // Set Pin to input
       selectPinInterruptLowLevel(PIN_TM4C_PORTE_INT); // Initialize interrupt to trigger on rising edge
@@ -80,57 +121,35 @@ void init_TM4C_hardware(void)
 /**
 *      @brief Function to initialize necessary pins and registers on IO expander
 *                  Write steps
-*                   - Clear CS
-*                   - Opcode into SPI register
-*                   - Address into SPI register
-*                   - Data into SPI register
-*                   - Set CS
+*                   - Opcode with the expander hardware address, register address and data packed into two 12-bit SPI frames
+*                   - SSI holds CS low while the FIFO has data
 *      @param register_address address to write into
 *      @param data data to write
 **/
 void write_MCP23S08(uint32_t register_address, uint32_t data)
 {
-      setPinValue(PIN_TM4C_PORTD_CHIP_SELECT, LOGIC_HIGH);  // Set CS line
-      setPinValue(PIN_TM4C_PORTD_CHIP_SELECT, LOGIC_LOW);   // Clear CS line
-
-      writeSpi1Data(OPCODE_MCP23S08_WRIT);                  // Transmit write opcode into IO expander
-      readSpi1Data();                                       // Read SPI register to clear register
-
-      writeSpi1Data(register_address);                      // Transmit address of register in IO expander to write into
-      readSpi1Data();                                       // Read SPI register to clear register
-
-      writeSpi1Data(data);                                  // Transmit data into IO expander
-      readSpi1Data();                                       // Read SPI register to clear register
-
-      setPinValue(PIN_TM4C_PORTD_CHIP_SELECT, LOGIC_HIGH);  // Set CS to indicate transmission complete
+      pauseLedPwm();                                        // Take the bus from the LED PWM stream
+      traceItm(ITM_PORT_SPI_START);
+      writeMcp23s08Register(EXPANDER_LED, register_address, data); // Write opcode, register address and data
+      traceItm(ITM_PORT_SPI_STOP);
+      resumeLedPwm();
 }
 
 /**
 *      @brief Function to read necessary pins and registers on IO expander in order to write to it
 *                  Write steps
-*                   - Clear CS
-*                   - Opcode into SPI register
-*                   - Address into SPI register
-*                   - Data from respective register address
-*                   - Set CS
+*                   - Opcode with the expander hardware address, register address and a dummy byte packed into two 12-bit SPI frames
+*                   - Data from respective register address clocked in by the dummy byte
 *      @param register_address address to write into
 *      @param data data to write
 **/
 uint32_t read_MCP23S08(uint32_t register_address)
 {
-      setPinValue(PIN_TM4C_PORTD_CHIP_SELECT, LOGIC_HIGH);  // Set CS line
-      setPinValue(PIN_TM4C_PORTD_CHIP_SELECT, LOGIC_LOW);   // Clear CS line
-
-      writeSpi1Data(OPCODE_MCP23S08_READ);                  // Transmit read opcode into IO expander
-      readSpi1Data();                                       // Read SPI register to clear register
-
-      writeSpi1Data(register_address);                      // Set the address of the register to read form
-      readSpi1Data();                                       // Read contents of interested register
-
-      writeSpi1Data(0x00);                                  // Dummy value to induce read
-      uint32_t retVal = readSpi1Data();
-
-      setPinValue(PIN_TM4C_PORTD_CHIP_SELECT, LOGIC_HIGH);  // Set CS to indicate transmission complete
+      pauseLedPwm();                                        // Take the bus from the LED PWM stream
+      traceItm(ITM_PORT_SPI_START);
+      uint32_t retVal = readMcp23s08Register(EXPANDER_LED, register_address);
+      traceItm(ITM_PORT_SPI_STOP);
+      resumeLedPwm();
 
       return retVal;
 }
@@ -141,8 +160,14 @@ uint32_t read_MCP23S08(uint32_t register_address)
 **/
 void PORTE_ISR()
 {
-      read_MCP23S08(PIN_MCP23S08_GPIO);
+      startLatencyEvent();
+      traceItm(ITM_PORT_ISR_ENTER + ITM_ISR_PORTE);
+      pauseLedPwm();                            // Direct LED writes below hold until the ISR exits
+      uint32_t gpio = read_MCP23S08(PIN_MCP23S08_GPIO);
+      markLatency(LATENCY_BUS_FIRST);
+      logUart0(LOG_ID_PORTE_ISR, gpio);
       write_MCP23S08(PIN_MCP23S08_GPIO, 0x00);  // Set LED pins if button has been pressed
+      markLatency(LATENCY_LED_WRITE);
 
       waitMicrosecond(100000);
 
@@ -151,10 +176,15 @@ void PORTE_ISR()
 
       waitMicrosecond(100000);
 
-      read_MCP23S08(PIN_MCP23S08_INTCAP);       // Read Interrupt register
+      uint8_t capture = read_MCP23S08(PIN_MCP23S08_INTCAP);   // Read Interrupt register
+      pushRing(&intcap_ring, capture);                        // Pass capture to main
+      logUart0(LOG_ID_INTCAP, capture);
       write_MCP23S08(PIN_MCP23S08_GPIO, 0x40);  // Set Red LED
+      setLedPwmPattern(LED_MASK_INDICATOR, LED_LEVEL_FULL);   // Keep it lit once the PWM stream resumes
 
       clearPinInterrupt(PIN_TM4C_PORTE_INT);
+      resumeLedPwm();
+      traceItm(ITM_PORT_ISR_EXIT + ITM_ISR_PORTE);
 }
 
 /**
@@ -163,6 +193,7 @@ void PORTE_ISR()
 void main(void)
 {
 
+      initRing(&intcap_ring, intcap_data, INTCAP_RING_SIZE);
       init_TM4C_hardware();
       // GPIO controls
       write_MCP23S08(PIN_MCP23S08_IODIR, VAL_MCP23S08_IODIR);           // Set pin directions (bit 07 = input; others = output)
@@ -174,6 +205,22 @@ void main(void)
 
       write_MCP23S08(PIN_MCP23S08_GPIO, 0x40);                          // Set Green LED pins
 
+      initLedPwm(EXPANDER_LED, LED_PWM_BITS, LED_PWM_REFRESH, SYSTEM_CLK); // Stream dimmable LED frames to the expander
+      setLedPwmPattern(LED_MASK_INDICATOR, LED_LEVEL_FULL);
+      updateLedPwm();
+      startLedPwm();
+
       while(true)                                                       // Run infinitely
-      {}
+      {
+            uint8_t capture;
+            while (popRing(&intcap_ring, &capture))                     // Handle interrupt captures outside the ISR
+            {
+                  if (!(capture & 0x80))                                // Button (bit 7) is active low
+                  {
+                        logUart0(LOG_ID_BUTTON, ++button_presses);
+                        setLedPwmFade(LED_PIN_INDICATOR, LED_LEVEL_DIM, LED_FADE_REFRESHES);
+                  }
+            }
+            updateLedPwm();                                             // Publish level and fade changes
+      }
 }
@@ -0,0 +1,214 @@
+// MCP23S08 Expander Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Up to four MCP23S08 sharing one chip select, address straps A1:A0 = 0 to 3
+
+// With IOCON.HAEN set each expander only answers opcodes carrying its own
+// A1:A0, so four parts share one chip select for 32 I/O lines. Until HAEN is
+// set every part answers every address, so the first IOCON write (to
+// address 0) reaches all of them at once. The later writes cover a warm
+// restart where HAEN is already set.
+//
+// A shadow copy of every register is kept per device. Configuration writes go
+// out immediately. Output changes made with setMcp23s08Outputs() only update
+// the OLAT shadow, and refreshMcp23s08Outputs() then queues one OLAT write
+// per changed device on the bus manager, which clocks them back to back from
+// the SSI ISR.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+#include "spi.h"
+#include "spibus.h"
+#include "mcp23s08.h"
+
+#define OPCODE_WRITE(device)    (0x40 | ((device) << 1))
+#define OPCODE_READ(device)     (0x41 | ((device) << 1))
+#define ACCESS_BYTES            3           // opcode, register, data
+#define ACCESS_WORDS            2           // as 12-bit frames
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+// One access in the frame format of the bus device
+typedef union _ACCESS
+{
+    uint8_t bytes[ACCESS_BYTES];
+    uint16_t words[ACCESS_WORDS];
+} ACCESS;
+
+static uint8_t busDevice;
+static uint8_t frameBits;
+static uint8_t present = 0;                 // bit n for a part at address n
+static uint8_t shadow[MCP23S08_MAX_DEVICES][MCP23S08_REGISTERS];
+static uint8_t dirty;                       // devices with OLAT changes to write
+static SPI_BUS_TRANSACTION refresh[MCP23S08_MAX_DEVICES];
+static ACCESS refreshAccess[MCP23S08_MAX_DEVICES];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Builds an access and returns its length in frames
+static uint16_t buildAccess(ACCESS* access, uint8_t opcode, uint8_t reg, uint8_t data)
+{
+    uint8_t bytes[ACCESS_BYTES] = {opcode, reg, data};
+    uint8_t i;
+
+    if (frameBits == 8)
+    {
+        for (i = 0; i < ACCESS_BYTES; i++)
+            access->bytes[i] = bytes[i];
+        return ACCESS_BYTES;
+    }
+    return packSpiWords(bytes, ACCESS_BYTES, access->words, frameBits);
+}
+
+// Returns false if the bus did not run the access, read is then left unchanged
+static bool runAccess(uint8_t opcode, uint8_t reg, uint8_t data, uint8_t* read)
+{
+    ACCESS access;
+    uint8_t bytes[ACCESS_BYTES];
+    SPI_BUS_TRANSACTION t;
+
+    t.device = busDevice;
+    t.tx = &access;
+    t.rx = &access;
+    t.count = buildAccess(&access, opcode, reg, data);
+    t.priority = getSpiBusCallerPriority();
+    if (runSpiBusTransaction(&t) != SPI_BUS_OK)
+        return false;
+    if (frameBits == 8)
+        *read = access.bytes[2];
+    else
+    {
+        unpackSpiWords(access.words, frameBits, bytes, ACCESS_BYTES);
+        *read = bytes[2];
+    }
+    return true;
+}
+
+// Registers the shared chip select with the bus manager, sets HAEN on every
+// part and loads the shadows from the devices
+// Returns false if bits is not 8 or 12 or the bus manager has no room for the device
+bool initMcp23s08(uint8_t ssi, uint32_t baudRate, uint8_t bits, PORT csPort, uint8_t csPin,
+                  uint8_t devices)
+{
+    uint8_t device, reg, read;
+
+    if (bits != 8 && bits != 12)            // an access must fill ACCESS exactly
+        return false;
+    busDevice = addSpiDevice(ssi, 1, 1, baudRate, bits, csPort, csPin);    // mode 3
+    if (busDevice == SPI_BUS_NO_DEVICE)
+        return false;
+    frameBits = bits;
+    present = devices;
+    dirty = 0;
+    for (device = 0; device < MCP23S08_MAX_DEVICES; device++)
+    {
+        refresh[device].status = SPI_BUS_OK;
+        if (device == 0 || (present & (1 << device)))
+            runAccess(OPCODE_WRITE(device), MCP23S08_IOCON, MCP23S08_IOCON_HAEN, &read);
+    }
+    for (device = 0; device < MCP23S08_MAX_DEVICES; device++)
+        if (present & (1 << device))
+            for (reg = 0; reg < MCP23S08_REGISTERS; reg++)
+            {
+                shadow[device][reg] = 0;
+                runAccess(OPCODE_READ(device), reg, 0, &shadow[device][reg]);
+            }
+    return true;
+}
+
+// Returns false if the bus did not run the write, the shadow is then unchanged
+bool writeMcp23s08Register(uint8_t device, uint8_t reg, uint8_t data)
+{
+    uint8_t read;
+    if (reg == MCP23S08_IOCON)
+        data |= MCP23S08_IOCON_HAEN;        // clearing HAEN would merge the devices
+    if (!runAccess(OPCODE_WRITE(device), reg, data, &read))
+        return false;
+    shadow[device][reg] = data;
+    return true;
+}
+
+// Reads the device and updates the shadow
+// Returns the shadow unchanged if the bus did not run the read
+uint8_t readMcp23s08Register(uint8_t device, uint8_t reg)
+{
+    runAccess(OPCODE_READ(device), reg, 0, &shadow[device][reg]);
+    return shadow[device][reg];
+}
+
+// Opcode for a write to device, for streams that address the part directly
+uint8_t getMcp23s08WriteOpcode(uint8_t device)
+{
+    return OPCODE_WRITE(device);
+}
+
+// Last value written or read, without a bus access
+uint8_t getMcp23s08Register(uint8_t device, uint8_t reg)
+{
+    return shadow[device][reg];
+}
+
+// Changes the masked output bits in the OLAT shadow, written by the next refresh
+void setMcp23s08Outputs(uint8_t device, uint8_t mask, uint8_t value)
+{
+    uint8_t olat = (shadow[device][MCP23S08_OLAT] & ~mask) | (value & mask);
+    if (olat != shadow[device][MCP23S08_OLAT])
+    {
+        shadow[device][MCP23S08_OLAT] = olat;
+        dirty |= 1 << device;
+    }
+}
+
+// Queues the OLAT writes of every changed device back to back
+// Returns the number of devices written, isMcp23s08RefreshDone() reports completion
+uint8_t refreshMcp23s08Outputs(void)
+{
+    uint8_t device, queued = 0;
+
+    for (device = 0; device < MCP23S08_MAX_DEVICES; device++)
+    {
+        SPI_BUS_TRANSACTION* t = &refresh[device];
+        if (!(dirty & (1 << device)) || t->status == SPI_BUS_PENDING)
+            continue;
+        t->device = busDevice;
+        t->tx = &refreshAccess[device];
+        t->rx = 0;
+        t->count = buildAccess(&refreshAccess[device], OPCODE_WRITE(device), MCP23S08_OLAT,
+                               shadow[device][MCP23S08_OLAT]);
+        t->priority = getSpiBusCallerPriority();
+        t->callback = 0;
+        if (queueSpiBusTransaction(t))
+        {
+            dirty &= ~(1 << device);
+            queued++;
+        }
+    }
+    return queued;
+}
+
+bool isMcp23s08RefreshDone(void)
+{
+    uint8_t device;
+    for (device = 0; device < MCP23S08_MAX_DEVICES; device++)
+        if (refresh[device].status == SPI_BUS_PENDING)
+            return false;
+    return true;
+}
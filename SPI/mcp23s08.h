@@ -0,0 +1,62 @@
+// MCP23S08 Expander Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Up to four MCP23S08 sharing one chip select, address straps A1:A0 = 0 to 3
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef MCP23S08_H_
+#define MCP23S08_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+
+#define MCP23S08_MAX_DEVICES    4
+
+// Registers
+#define MCP23S08_IODIR          0x00
+#define MCP23S08_IPOL           0x01
+#define MCP23S08_GPINTEN        0x02
+#define MCP23S08_DEFVAL         0x03
+#define MCP23S08_INTCON         0x04
+#define MCP23S08_IOCON          0x05
+#define MCP23S08_GPPU           0x06
+#define MCP23S08_INTF           0x07
+#define MCP23S08_INTCAP         0x08
+#define MCP23S08_GPIO           0x09
+#define MCP23S08_OLAT           0x0A
+#define MCP23S08_REGISTERS      11
+
+#define MCP23S08_IOCON_SEQOP    0x20        // disable address pointer increment
+#define MCP23S08_IOCON_HAEN     0x08        // hardware address enable
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// bits is the SPI frame size, 8 or 12 (a 3 byte access is two 12-bit frames),
+// other sizes are rejected
+// devices has bit n set for a part strapped to hardware address n
+bool initMcp23s08(uint8_t ssi, uint32_t baudRate, uint8_t bits, PORT csPort, uint8_t csPin,
+                  uint8_t devices);
+bool writeMcp23s08Register(uint8_t device, uint8_t reg, uint8_t data);
+uint8_t readMcp23s08Register(uint8_t device, uint8_t reg);
+uint8_t getMcp23s08Register(uint8_t device, uint8_t reg);
+uint8_t getMcp23s08WriteOpcode(uint8_t device);
+void setMcp23s08Outputs(uint8_t device, uint8_t mask, uint8_t value);
+uint8_t refreshMcp23s08Outputs(void);
+bool isMcp23s08RefreshDone(void);
+
+#endif
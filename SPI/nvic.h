@@ -19,6 +19,16 @@
 #define NVIC_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// Static priority plan (0 = most urgent, 7 = least urgent)
+// Bus drivers protect their state with enterNvicCriticalSection(PRIORITY_BUS),
+// which never delays interrupts at PRIORITY_TIMING or PRIORITY_CRITICAL
+#define PRIORITY_CRITICAL   0                   // never masked by BASEPRI (watchdog supervisor)
+#define PRIORITY_TIMING     1                   // timestamp and capture interrupts
+#define PRIORITY_BUS        3                   // SSI, I2C, UART and uDMA completion
+#define PRIORITY_GPIO       4                   // expander and push button interrupts
+#define PRIORITY_BACKGROUND 6                   // deferred work
 
 //-----------------------------------------------------------------------------
 // Subroutines
@@ -27,5 +37,17 @@
 void enableNvicInterrupt(uint8_t vectorNumber);
 void disableNvicInterrupt(uint8_t vectorNumber);
 void setNvicInterruptPriority(uint8_t vectorNumber, uint8_t priority);
+void setNvicInterruptPending(uint8_t vectorNumber);
+void clearNvicInterruptPending(uint8_t vectorNumber);
+bool isNvicInterruptPending(uint8_t vectorNumber);
+bool isNvicInterruptActive(uint8_t vectorNumber);
+void setNvicPriorityGrouping(uint8_t prigroup);
+uint8_t getNvicPriorityGrouping(void);
+
+uint32_t getNvicBasePriority(void);
+void setNvicBasePriority(uint32_t basePriority);
+void raiseNvicBasePriority(uint32_t basePriority);
+uint32_t enterNvicCriticalSection(uint8_t priority);
+void leaveNvicCriticalSection(uint32_t state);
 
 #endif
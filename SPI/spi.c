@@ -0,0 +1,510 @@
+// SPI Library
+// Jason Losh
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// SPI0 Interface: CLK PA2, FSS PA3, RX PA4, TX PA5
+// SPI1 Interface: CLK PD0, FSS PD1, RX PD2, TX PD3
+// SPI2 Interface: CLK PB4, FSS PB5, RX PB6, TX PB7
+// SPI3 Interface: CLK PD0, FSS PD1, RX PD2, TX PD3 (shares pins with SPI1)
+
+// Each SSI module has its own register block, pin mux, uDMA channel pair and
+// transfer state, so transfers on different modules run concurrently.
+// startSpiTransfer() moves a buffer with uDMA when the module was initialized
+// with USE_SSI_DMA and both channels could be allocated, otherwise the SSI
+// ISR keeps the TX FIFO topped up from the RX half-full and timeout
+// interrupts. The blocking byte functions are unchanged.
+//
+// transferSpiFrame() sends a short register transaction as one frame. With
+// USE_SSI_FSS and SPH=1 the SSI holds FSS low for as long as the TX FIFO has
+// another word, so a frame that fits the FIFO is queued in one burst and the
+// hardware frames it without any chip select writes. Longer frames, SPH=0
+// (where FSS pulses between words) and streams paced by other triggers take
+// the pin back as a GPIO with selectSpiFss()/deselectSpiFss().
+//
+// Frames are 8 bits unless setSpiDataSize() or transferSpiWords() selects
+// another size (4 to 16 bits). A wider frame moves more bits per FIFO push
+// and pop, e.g. a 3 byte MCP23S08 access fits two 12-bit frames.
+// packSpiWords()/unpackSpiWords() convert a byte stream to and from frames
+// MSB first. The blocking frame functions select their own frame size,
+// startSpiTransfer() uses the current one, and changing the size only
+// touches CR0 when the size actually changes.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "udma.h"
+#include "spi.h"
+
+#define SSI_REG(ssi, reg)   (*((volatile uint32_t *)(ssiBase[ssi] + ((uintptr_t)&(reg) - (uintptr_t)&SSI0_CR0_R))))
+#define SSI_DMA_ARB_LOG2    2               // 4 items, the FIFO half-level request size
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _SSI_PINS
+{
+    PORT port;
+    uint8_t clk, fss, rx, tx;
+    uint32_t clkFn, fssFn, rxFn, txFn;
+} SSI_PINS;
+
+typedef struct _SSI_DMA
+{
+    uint8_t rxChannel, rxEncoding;
+    uint8_t txChannel, txEncoding;
+} SSI_DMA;
+
+typedef struct _SPI_STATE
+{
+    const void* tx;                         // uint8_t frames up to 8 bits, uint16_t above
+    void* rx;
+    bool wide;
+    uint16_t count;
+    uint16_t sent;
+    uint16_t received;
+    volatile bool busy;
+    bool dma;
+    bool hardwareFss;
+    uint8_t dataSize;                       // bits per frame
+    SPI_CALLBACK callback;
+    uint32_t bytes;
+    const SSI_PINS* pins;                   // ssiPins[] or ssi1AltPins
+} SPI_STATE;
+
+static const uint32_t ssiBase[SPI_COUNT] = {0x40008000, 0x40009000, 0x4000A000, 0x4000B000};
+static const uint8_t ssiVector[SPI_COUNT] = {INT_SSI0, INT_SSI1, INT_SSI2, INT_SSI3};
+
+static const SSI_PINS ssiPins[SPI_COUNT] =
+{
+    {PORTA, 2, 3, 4, 5, GPIO_PCTL_PA2_SSI0CLK, GPIO_PCTL_PA3_SSI0FSS, GPIO_PCTL_PA4_SSI0RX, GPIO_PCTL_PA5_SSI0TX},
+    {PORTD, 0, 1, 2, 3, GPIO_PCTL_PD0_SSI1CLK, GPIO_PCTL_PD1_SSI1FSS, GPIO_PCTL_PD2_SSI1RX, GPIO_PCTL_PD3_SSI1TX},
+    {PORTB, 4, 5, 6, 7, GPIO_PCTL_PB4_SSI2CLK, GPIO_PCTL_PB5_SSI2FSS, GPIO_PCTL_PB6_SSI2RX, GPIO_PCTL_PB7_SSI2TX},
+    {PORTD, 0, 1, 2, 3, GPIO_PCTL_PD0_SSI3CLK, GPIO_PCTL_PD1_SSI3FSS, GPIO_PCTL_PD2_SSI3RX, GPIO_PCTL_PD3_SSI3TX}
+};
+
+// SSI1 and SSI3 share PD0-PD3; with USE_SSI_ALT_PINS SSI1 moves to PF0-PF3 so both can run
+static const SSI_PINS ssi1AltPins =
+    {PORTF, 2, 3, 0, 1, GPIO_PCTL_PF2_SSI1CLK, GPIO_PCTL_PF3_SSI1FSS, GPIO_PCTL_PF0_SSI1RX, GPIO_PCTL_PF1_SSI1TX};
+
+// SSI1 uses channels 24/25 so SSI0 keeps 10/11; ADC1 sequencer 0 also wants 24
+static const SSI_DMA ssiDma[SPI_COUNT] =
+{
+    {10, UDMA_CH10_SSI0RX, 11, UDMA_CH11_SSI0TX},
+    {24, UDMA_CH24_SSI1RX, 25, UDMA_CH25_SSI1TX},
+    {12, UDMA_CH12_SSI2RX, 13, UDMA_CH13_SSI2TX},
+    {14, UDMA_CH14_SSI3RX, 15, UDMA_CH15_SSI3TX}
+};
+
+static SPI_STATE spiState[SPI_COUNT];
+static const uint16_t txIdle = 0;           // sent when a transfer has no tx buffer
+static uint16_t rxDiscard;                  // receives when a transfer has no rx buffer
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static inline uint16_t getTxWord(const void* tx, bool wide, uint16_t i)
+{
+    if (!tx)
+        return txIdle;
+    return wide ? ((const uint16_t*)tx)[i] : ((const uint8_t*)tx)[i];
+}
+
+static inline void putRxWord(void* rx, bool wide, uint16_t i, uint16_t data)
+{
+    if (!rx)
+        return;
+    if (wide)
+        ((uint16_t*)rx)[i] = data;
+    else
+        ((uint8_t*)rx)[i] = data;
+}
+
+static void finishTransfer(uint8_t ssi)
+{
+    SPI_STATE* state = &spiState[ssi];
+    SSI_REG(ssi, SSI0_IM_R) = 0;
+    SSI_REG(ssi, SSI0_DMACTL_R) = 0;
+    state->bytes += state->count * ((state->dataSize + 7) / 8);
+    state->busy = false;
+    if (state->callback)
+        state->callback(ssi);
+}
+
+// uDMA completion, the TX request stays asserted until TXDMAE is cleared
+static void spiDmaComplete(uint8_t channel, bool alternate)
+{
+    uint8_t ssi;
+    for (ssi = 0; ssi < SPI_COUNT; ssi++)
+    {
+        if (channel == ssiDma[ssi].txChannel)
+            SSI_REG(ssi, SSI0_DMACTL_R) &= ~SSI_DMACTL_TXDMAE;
+        else if (channel == ssiDma[ssi].rxChannel)
+            finishTransfer(ssi);
+    }
+}
+
+// Initialize an SSI module
+void initSpi(uint8_t ssi, uint32_t pinMask)
+{
+    const SSI_PINS* pins = (ssi == SPI1 && (pinMask & USE_SSI_ALT_PINS)) ? &ssi1AltPins : &ssiPins[ssi];
+    SPI_STATE* state = &spiState[ssi];
+
+    // Enable clocks
+    SYSCTL_RCGCSSI_R |= 1 << ssi;
+    _delay_cycles(3);
+    enablePort(pins->port);
+    state->pins = pins;
+    if (pins == &ssi1AltPins && (pinMask & USE_SSI_RX))
+        setPinCommitControl(pins->port, pins->rx);      // PF0 is locked (NMI) out of reset
+
+    // Configure SSI pins for SPI configuration
+    selectPinPushPullOutput(pins->port, pins->tx);
+    setPinAuxFunction(pins->port, pins->tx, pins->txFn);
+    selectPinPushPullOutput(pins->port, pins->clk);
+    setPinAuxFunction(pins->port, pins->clk, pins->clkFn);
+    selectPinPushPullOutput(pins->port, pins->fss);
+    if (pinMask & USE_SSI_FSS)
+    {
+        setPinAuxFunction(pins->port, pins->fss, pins->fssFn);
+    }
+    if (pinMask & USE_SSI_RX)
+    {
+        selectPinDigitalInput(pins->port, pins->rx);
+        setPinAuxFunction(pins->port, pins->rx, pins->rxFn);
+    }
+
+    // Configure the SSI as a SPI master, mode 3, 8bit operation
+    SSI_REG(ssi, SSI0_CR1_R) &= ~SSI_CR1_SSE;          // turn off SSI to allow re-configuration
+    SSI_REG(ssi, SSI0_CR1_R) = 0;                      // select master mode
+    SSI_REG(ssi, SSI0_CC_R) = 0;                       // select system clock as the clock source
+    SSI_REG(ssi, SSI0_CR0_R) = SSI_CR0_FRF_MOTO | SSI_CR0_DSS_8; // set SR=0, 8-bit
+    SSI_REG(ssi, SSI0_IM_R) = 0;
+    SSI_REG(ssi, SSI0_DMACTL_R) = 0;
+
+    state->busy = false;
+    state->bytes = 0;
+    state->dma = false;
+    state->hardwareFss = pinMask & USE_SSI_FSS;
+    state->dataSize = 8;
+    setPinValue(pins->port, pins->fss, 1);
+    if (pinMask & USE_SSI_DMA)
+    {
+        const SSI_DMA* dma = &ssiDma[ssi];
+        if (allocateUdmaChannel(dma->rxChannel, dma->rxEncoding, spiDmaComplete))
+        {
+            if (allocateUdmaChannel(dma->txChannel, dma->txEncoding, spiDmaComplete))
+                state->dma = true;
+            else
+                freeUdmaChannel(dma->rxChannel);
+        }
+    }
+    setNvicInterruptPriority(ssiVector[ssi], PRIORITY_BUS);
+    enableNvicInterrupt(ssiVector[ssi]);
+}
+
+// Set baud rate as function of instruction cycle frequency
+void setSpiBaudRate(uint8_t ssi, uint32_t baudRate, uint32_t fcyc)
+{
+    uint32_t divisorTimes2 = (fcyc * 2) / baudRate;    // calculate divisor (r) times 2
+    SSI_REG(ssi, SSI0_CR1_R) &= ~SSI_CR1_SSE;          // turn off SSI to allow re-configuration
+    SSI_REG(ssi, SSI0_CPSR_R) = (divisorTimes2 + 1) >> 1; // round divisor to nearest integer
+    SSI_REG(ssi, SSI0_CR1_R) |= SSI_CR1_SSE;           // turn on SSI
+}
+
+// Selects 4 to 16 bit frames, call while the SSI is idle
+void setSpiDataSize(uint8_t ssi, uint8_t bits)
+{
+    SPI_STATE* state = &spiState[ssi];
+    if (state->dataSize == bits)
+        return;
+    SSI_REG(ssi, SSI0_CR1_R) &= ~SSI_CR1_SSE;          // turn off SSI to allow re-configuration
+    SSI_REG(ssi, SSI0_CR0_R) = (SSI_REG(ssi, SSI0_CR0_R) & ~SSI_CR0_DSS_M) | (bits - 1);
+    SSI_REG(ssi, SSI0_CR1_R) |= SSI_CR1_SSE;           // turn on SSI
+    state->dataSize = bits;
+}
+
+// Set mode
+void setSpiMode(uint8_t ssi, uint8_t polarity, uint8_t phase)
+{
+    const SSI_PINS* pins = spiState[ssi].pins;
+    SSI_REG(ssi, SSI0_CR1_R) &= ~SSI_CR1_SSE;          // turn off SSI to allow re-configuration
+    SSI_REG(ssi, SSI0_CR0_R) &= ~(SSI_CR0_SPH | SSI_CR0_SPO); // set SPO and SPH as appropriate
+    if (polarity)
+    {
+        SSI_REG(ssi, SSI0_CR0_R) |= SSI_CR0_SPO;
+        enablePinPullup(pins->port, pins->clk);
+    }
+    else
+        disablePinPullup(pins->port, pins->clk);
+    if (phase)
+        SSI_REG(ssi, SSI0_CR0_R) |= SSI_CR0_SPH;
+    SSI_REG(ssi, SSI0_CR1_R) |= SSI_CR1_SSE;           // turn on SSI
+}
+
+// Blocking function that writes data and waits until the tx buffer is empty
+void writeSpiData(uint8_t ssi, uint32_t data)
+{
+    SSI_REG(ssi, SSI0_DR_R) = data;
+    while (SSI_REG(ssi, SSI0_SR_R) & SSI_SR_BSY);
+}
+
+// Reads data from the rx buffer after a write
+uint32_t readSpiData(uint8_t ssi)
+{
+    return SSI_REG(ssi, SSI0_DR_R);
+}
+
+// Discards unread rx data and clears a receive overrun
+void drainSpiRx(uint8_t ssi)
+{
+    while (SSI_REG(ssi, SSI0_SR_R) & SSI_SR_RNE)
+        SSI_REG(ssi, SSI0_DR_R);
+    SSI_REG(ssi, SSI0_ICR_R) = SSI_ICR_RORIC;
+}
+
+bool isSpiBusy(uint8_t ssi)
+{
+    return SSI_REG(ssi, SSI0_SR_R) & SSI_SR_BSY;
+}
+
+// Lowers FSS under software control, taking the pin from the SSI if needed
+// The latch is cleared before AFSEL so the pin goes straight from the idle
+// SSI level to low
+void selectSpiFss(uint8_t ssi)
+{
+    const SSI_PINS* pins = spiState[ssi].pins;
+    setPinValue(pins->port, pins->fss, 0);
+    if (spiState[ssi].hardwareFss)
+        setPinAuxFunction(pins->port, pins->fss, 0);
+}
+
+// Raises FSS and returns the pin to the SSI, call once the SSI is idle
+void deselectSpiFss(uint8_t ssi)
+{
+    const SSI_PINS* pins = spiState[ssi].pins;
+    setPinValue(pins->port, pins->fss, 1);
+    if (spiState[ssi].hardwareFss)
+        setPinAuxFunction(pins->port, pins->fss, pins->fssFn);
+}
+
+static void transferFrame(uint8_t ssi, const void* tx, void* rx, uint16_t count, bool wide)
+{
+    SPI_STATE* state = &spiState[ssi];
+    uint32_t section;
+    uint16_t i;
+
+    drainSpiRx(ssi);
+    if (state->hardwareFss && count <= SSI_FIFO_DEPTH && (SSI_REG(ssi, SSI0_CR0_R) & SSI_CR0_SPH))
+    {
+        // FSS rises if the FIFO runs dry, so nothing may preempt the fill
+        section = enterNvicCriticalSection(PRIORITY_BUS);
+        for (i = 0; i < count; i++)
+            SSI_REG(ssi, SSI0_DR_R) = getTxWord(tx, wide, i);
+        leaveNvicCriticalSection(section);
+        while (SSI_REG(ssi, SSI0_SR_R) & SSI_SR_BSY);
+        for (i = 0; i < count; i++)
+            putRxWord(rx, wide, i, SSI_REG(ssi, SSI0_DR_R));
+    }
+    else
+    {
+        selectSpiFss(ssi);
+        for (i = 0; i < count; i++)
+        {
+            writeSpiData(ssi, getTxWord(tx, wide, i));
+            putRxWord(rx, wide, i, readSpiData(ssi));
+        }
+        deselectSpiFss(ssi);
+    }
+    state->bytes += count * ((state->dataSize + 7) / 8);
+}
+
+// Sends count bytes as one FSS-low frame and waits for it to complete
+// tx may be 0 to send zeros, rx may be 0 to discard
+void transferSpiFrame(uint8_t ssi, const uint8_t tx[], uint8_t rx[], uint16_t count)
+{
+    setSpiDataSize(ssi, 8);
+    transferFrame(ssi, tx, rx, count, false);
+}
+
+// As transferSpiFrame with count words of bits (4 to 16) each
+void transferSpiWords(uint8_t ssi, uint8_t bits, const uint16_t tx[], uint16_t rx[], uint16_t count)
+{
+    setSpiDataSize(ssi, bits);
+    transferFrame(ssi, tx, rx, count, true);
+}
+
+// Packs byteCount bytes MSB first into words of bits each, zero filling the
+// end of the last word; returns the number of words
+uint16_t packSpiWords(const uint8_t bytes[], uint16_t byteCount, uint16_t words[], uint8_t bits)
+{
+    uint32_t acc = 0;
+    uint8_t accBits = 0;
+    uint16_t i, n = 0;
+
+    for (i = 0; i < byteCount; i++)
+    {
+        acc = (acc << 8) | bytes[i];
+        accBits += 8;
+        while (accBits >= bits)
+        {
+            accBits -= bits;
+            words[n++] = (acc >> accBits) & ((1u << bits) - 1);
+        }
+    }
+    if (accBits)
+        words[n++] = (acc << (bits - accBits)) & ((1u << bits) - 1);
+    return n;
+}
+
+// Unpacks words of bits each MSB first into byteCount bytes
+void unpackSpiWords(const uint16_t words[], uint8_t bits, uint8_t bytes[], uint16_t byteCount)
+{
+    uint32_t acc = 0;
+    uint8_t accBits = 0;
+    uint16_t i = 0, n = 0;
+
+    while (n < byteCount)
+    {
+        if (accBits < 8)
+        {
+            acc = (acc << bits) | words[i++];
+            accBits += bits;
+        }
+        else
+        {
+            accBits -= 8;
+            bytes[n++] = acc >> accBits;
+        }
+    }
+}
+
+// Data register address, for streams paced by other uDMA triggers
+volatile uint32_t* getSpiDataRegister(uint8_t ssi)
+{
+    return &SSI_REG(ssi, SSI0_DR_R);
+}
+
+// Keeps at most one FIFO depth of bytes in flight
+static void fillTxFifo(uint8_t ssi)
+{
+    SPI_STATE* state = &spiState[ssi];
+    while (state->sent < state->count && (uint16_t)(state->sent - state->received) < SSI_FIFO_DEPTH
+           && (SSI_REG(ssi, SSI0_SR_R) & SSI_SR_TNF))
+    {
+        SSI_REG(ssi, SSI0_DR_R) = getTxWord(state->tx, state->wide, state->sent);
+        state->sent++;
+    }
+}
+
+// Starts a full duplex transfer of count frames at the current data size and
+// returns immediately; the buffers hold uint8_t frames up to 8 bits and
+// uint16_t frames above
+// tx may be 0 to clock out zeros and rx may be 0 to discard the input; chip
+// select is left to the caller, callback runs from the SSI ISR on completion
+// Returns false if a transfer is already running on this module
+bool startSpiTransfer(uint8_t ssi, const void* tx, void* rx, uint16_t count,
+                      SPI_CALLBACK callback)
+{
+    SPI_STATE* state = &spiState[ssi];
+    volatile uint32_t* dr = &SSI_REG(ssi, SSI0_DR_R);
+    uint8_t size;
+
+    if (state->busy || count == 0)
+        return false;
+    drainSpiRx(ssi);
+    state->tx = tx;
+    state->rx = rx;
+    state->wide = state->dataSize > 8;
+    size = state->wide ? UDMA_SIZE_16 : UDMA_SIZE_8;
+    state->count = count;
+    state->sent = 0;
+    state->received = 0;
+    state->callback = callback;
+    state->busy = true;
+
+    if (state->dma && count <= UDMA_MAX_TRANSFER)
+    {
+        const SSI_DMA* dma = &ssiDma[ssi];
+        startUdmaBasic(dma->rxChannel, dr, rx ? rx : &rxDiscard, size, UDMA_INC_NONE,
+                       rx ? UDMA_INC_ITEM : UDMA_INC_NONE, SSI_DMA_ARB_LOG2, count);
+        startUdmaBasic(dma->txChannel, tx ? tx : &txIdle, dr, size,
+                       tx ? UDMA_INC_ITEM : UDMA_INC_NONE, UDMA_INC_NONE, SSI_DMA_ARB_LOG2, count);
+        SSI_REG(ssi, SSI0_DMACTL_R) = SSI_DMACTL_TXDMAE | SSI_DMACTL_RXDMAE;
+    }
+    else
+    {
+        fillTxFifo(ssi);
+        SSI_REG(ssi, SSI0_IM_R) = SSI_IM_RXIM | SSI_IM_RTIM;
+    }
+    return true;
+}
+
+bool isSpiTransferDone(uint8_t ssi)
+{
+    return !spiState[ssi].busy;
+}
+
+// Bytes moved by completed transfers, for throughput accounting
+uint32_t getSpiBytes(uint8_t ssi)
+{
+    return spiState[ssi].bytes;
+}
+
+static void serviceSpi(uint8_t ssi)
+{
+    SPI_STATE* state = &spiState[ssi];
+    const SSI_DMA* dma = &ssiDma[ssi];
+    uint16_t data;
+
+    if (state->dma)
+        serviceUdmaCompletions((1 << dma->rxChannel) | (1 << dma->txChannel));
+    if (!state->busy || SSI_REG(ssi, SSI0_DMACTL_R))
+        return;
+    SSI_REG(ssi, SSI0_ICR_R) = SSI_ICR_RTIC;
+    while (SSI_REG(ssi, SSI0_SR_R) & SSI_SR_RNE)
+    {
+        data = SSI_REG(ssi, SSI0_DR_R);
+        putRxWord(state->rx, state->wide, state->received, data);
+        state->received++;
+    }
+    if (state->received == state->count)
+        finishTransfer(ssi);
+    else
+        fillTxFifo(ssi);
+}
+
+void spi0Isr(void)
+{
+    serviceSpi(SPI0);
+}
+
+void spi1Isr(void)
+{
+    serviceSpi(SPI1);
+}
+
+void spi2Isr(void)
+{
+    serviceSpi(SPI2);
+}
+
+void spi3Isr(void)
+{
+    serviceSpi(SPI3);
+}
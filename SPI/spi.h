@@ -0,0 +1,76 @@
+// SPI Library
+// Jason Losh
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// SPI0 Interface: CLK PA2, FSS PA3, RX PA4, TX PA5
+// SPI1 Interface: CLK PD0, FSS PD1, RX PD2, TX PD3
+// SPI2 Interface: CLK PB4, FSS PB5, RX PB6, TX PB7
+// SPI3 Interface: CLK PD0, FSS PD1, RX PD2, TX PD3 (shares pins with SPI1)
+// SPI1 alternate:  CLK PF2, FSS PF3, RX PF0, TX PF1 (USE_SSI_ALT_PINS, lets SPI1
+//                  and SPI3 run together; PF1-PF3 also drive the LaunchPad LED)
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SPI_H_
+#define SPI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SPI0 0
+#define SPI1 1
+#define SPI2 2
+#define SPI3 3
+#define SPI_COUNT 4
+
+#define USE_SSI_FSS 1
+#define USE_SSI_RX  2
+#define USE_SSI_DMA 4                       // move transfers with uDMA when the channels are free
+#define USE_SSI_ALT_PINS 8                  // SPI1 on PF0-PF3 instead of PD0-PD3
+
+#define SSI_FIFO_DEPTH 8                    // longest frame the hardware FSS can hold low
+
+// Called from the SSI ISR when a transfer started with startSpiTransfer() completes
+typedef void (*SPI_CALLBACK)(uint8_t ssi);
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initSpi(uint8_t ssi, uint32_t pinMask);
+void setSpiBaudRate(uint8_t ssi, uint32_t clockRate, uint32_t fcyc);
+void setSpiMode(uint8_t ssi, uint8_t polarity, uint8_t phase);
+void setSpiDataSize(uint8_t ssi, uint8_t bits);
+void writeSpiData(uint8_t ssi, uint32_t data);
+uint32_t readSpiData(uint8_t ssi);
+void drainSpiRx(uint8_t ssi);
+bool isSpiBusy(uint8_t ssi);
+volatile uint32_t* getSpiDataRegister(uint8_t ssi);
+void selectSpiFss(uint8_t ssi);
+void deselectSpiFss(uint8_t ssi);
+void transferSpiFrame(uint8_t ssi, const uint8_t tx[], uint8_t rx[], uint16_t count);
+void transferSpiWords(uint8_t ssi, uint8_t bits, const uint16_t tx[], uint16_t rx[], uint16_t count);
+uint16_t packSpiWords(const uint8_t bytes[], uint16_t byteCount, uint16_t words[], uint8_t bits);
+void unpackSpiWords(const uint16_t words[], uint8_t bits, uint8_t bytes[], uint16_t byteCount);
+
+bool startSpiTransfer(uint8_t ssi, const void* tx, void* rx, uint16_t count,
+                      SPI_CALLBACK callback);
+bool isSpiTransferDone(uint8_t ssi);
+uint32_t getSpiBytes(uint8_t ssi);
+
+void spi0Isr(void);
+void spi1Isr(void);
+void spi2Isr(void);
+void spi3Isr(void);
+
+#endif
@@ -0,0 +1,234 @@
+// SPI Bus Manager Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Any SSI module set up with initSpi(), devices selected by its FSS or by GPIO pins
+
+// Devices register their mode, baud rate, frame size and chip select once.
+// Every access is a transaction in the queue of its module, and the SSI ISR
+// completion of one transaction starts the next, so a thread and an ISR
+// sharing a module are serialized without a lock. The queue is ordered by
+// priority, so a transaction queued from an ISR runs ahead of queued thread
+// work. A transaction already on the wire is never split, since its chip
+// select must stay low. Mode and baud rate are only rewritten when the next
+// transaction is for a different device than the last. The frame size is
+// cached by spi.c, so it is checked on every transaction in case a stream
+// outside the manager changed it.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "spi.h"
+#include "spibus.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _SPI_DEVICE
+{
+    uint8_t ssi;
+    uint8_t polarity;
+    uint8_t phase;
+    uint8_t bits;
+    uint32_t baudRate;
+    PORT csPort;
+    uint8_t csPin;                          // SPI_BUS_FSS for the module FSS
+} SPI_DEVICE;
+
+typedef struct _SPI_BUS
+{
+    SPI_BUS_TRANSACTION* queue[SPI_BUS_QUEUE_SIZE];   // highest priority first
+    uint8_t count;
+    SPI_BUS_TRANSACTION* active;
+    uint8_t current;                        // device the SSI is configured for
+    bool softwareFss;                       // active transaction holds FSS by GPIO
+    uint32_t reconfigurations;
+} SPI_BUS;
+
+static SPI_DEVICE devices[SPI_BUS_DEVICES];
+static uint8_t deviceCount = 0;
+static SPI_BUS buses[SPI_COUNT];
+static uint32_t busFcyc;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initSpiBus(uint32_t fcyc)
+{
+    uint8_t ssi;
+    busFcyc = fcyc;
+    deviceCount = 0;
+    for (ssi = 0; ssi < SPI_COUNT; ssi++)
+    {
+        buses[ssi].count = 0;
+        buses[ssi].active = 0;
+        buses[ssi].current = SPI_BUS_NO_DEVICE;
+        buses[ssi].reconfigurations = 0;
+    }
+}
+
+// Returns the device handle, or SPI_BUS_NO_DEVICE if the table is full
+uint8_t addSpiDevice(uint8_t ssi, uint8_t polarity, uint8_t phase, uint32_t baudRate, uint8_t bits,
+                     PORT csPort, uint8_t csPin)
+{
+    SPI_DEVICE* device;
+
+    if (deviceCount == SPI_BUS_DEVICES)
+        return SPI_BUS_NO_DEVICE;
+    device = &devices[deviceCount];
+    device->ssi = ssi;
+    device->polarity = polarity;
+    device->phase = phase;
+    device->bits = bits;
+    device->baudRate = baudRate;
+    device->csPort = csPort;
+    device->csPin = csPin;
+    if (csPin != SPI_BUS_FSS)
+    {
+        enablePort(csPort);
+        setPinValue(csPort, csPin, 1);
+        selectPinPushPullOutput(csPort, csPin);
+    }
+    return deviceCount++;
+}
+
+static void completeTransaction(uint8_t ssi);
+
+// Releases the chip select of the active transaction and reports status
+static void endTransaction(uint8_t ssi, uint8_t status)
+{
+    SPI_BUS* bus = &buses[ssi];
+    SPI_BUS_TRANSACTION* t = bus->active;
+    SPI_DEVICE* device = &devices[t->device];
+
+    if (bus->softwareFss)
+        deselectSpiFss(ssi);
+    else if (device->csPin != SPI_BUS_FSS)
+        setPinValue(device->csPort, device->csPin, 1);
+    bus->active = 0;
+    t->status = status;
+    if (t->callback)
+        t->callback(t);
+}
+
+// Starts the transaction at the head of the queue, if any
+// A transaction the SSI refuses (a transfer started outside the manager is
+// still running) ends with SPI_BUS_BUSY rather than staying pending
+static void startNext(uint8_t ssi)
+{
+    SPI_BUS* bus = &buses[ssi];
+    SPI_BUS_TRANSACTION* t;
+    SPI_DEVICE* device;
+    uint8_t i;
+
+    // A callback of a refused transaction may already have started the next
+    while (bus->count > 0 && !bus->active)
+    {
+        t = bus->queue[0];
+        for (i = 1; i < bus->count; i++)
+            bus->queue[i - 1] = bus->queue[i];
+        bus->count--;
+        bus->active = t;
+        device = &devices[t->device];
+
+        if (bus->current != t->device)
+        {
+            setSpiBaudRate(ssi, device->baudRate, busFcyc);
+            setSpiMode(ssi, device->polarity, device->phase);
+            bus->current = t->device;
+            bus->reconfigurations++;
+        }
+        setSpiDataSize(ssi, device->bits);
+
+        // The SSI only holds FSS low across words that are already in the FIFO
+        bus->softwareFss = device->csPin == SPI_BUS_FSS && (t->count > SSI_FIFO_DEPTH || !device->phase);
+        if (bus->softwareFss)
+            selectSpiFss(ssi);
+        else if (device->csPin != SPI_BUS_FSS)
+            setPinValue(device->csPort, device->csPin, 0);
+        if (!startSpiTransfer(ssi, t->tx, t->rx, t->count, completeTransaction))
+            endTransaction(ssi, SPI_BUS_BUSY);
+    }
+}
+
+static void completeTransaction(uint8_t ssi)
+{
+    endTransaction(ssi, SPI_BUS_OK);
+    startNext(ssi);
+}
+
+// Queues a transaction behind those of equal or higher priority
+// Returns false, with the reason in status, if it moves no data
+// (SPI_BUS_INVALID) or the queue is full (SPI_BUS_QUEUE_FULL)
+bool queueSpiBusTransaction(SPI_BUS_TRANSACTION* transaction)
+{
+    SPI_BUS* bus = &buses[devices[transaction->device].ssi];
+    uint32_t section;
+    uint8_t i;
+    bool ok = false;
+
+    if (transaction->count == 0)
+    {
+        transaction->status = SPI_BUS_INVALID;
+        return false;
+    }
+    transaction->status = SPI_BUS_PENDING;
+    section = enterNvicCriticalSection(PRIORITY_BUS);
+    if (bus->count < SPI_BUS_QUEUE_SIZE)
+    {
+        for (i = bus->count; i > 0 && bus->queue[i - 1]->priority < transaction->priority; i--)
+            bus->queue[i] = bus->queue[i - 1];
+        bus->queue[i] = transaction;
+        bus->count++;
+        if (!bus->active)
+            startNext(devices[transaction->device].ssi);
+        ok = true;
+    }
+    else
+        transaction->status = SPI_BUS_QUEUE_FULL;
+    leaveNvicCriticalSection(section);
+    return ok;
+}
+
+uint8_t waitSpiBusTransaction(SPI_BUS_TRANSACTION* transaction)
+{
+    while (transaction->status == SPI_BUS_PENDING);
+    return transaction->status;
+}
+
+// Queues and waits, must not be called at or above PRIORITY_BUS
+uint8_t runSpiBusTransaction(SPI_BUS_TRANSACTION* transaction)
+{
+    transaction->callback = 0;
+    if (!queueSpiBusTransaction(transaction))
+        return transaction->status;
+    return waitSpiBusTransaction(transaction);
+}
+
+// SPI_BUS_PRIORITY_ISR when called from an exception handler
+uint8_t getSpiBusCallerPriority(void)
+{
+    return (NVIC_INT_CTRL_R & NVIC_INT_CTRL_VEC_ACT_M) ? SPI_BUS_PRIORITY_ISR : SPI_BUS_PRIORITY_THREAD;
+}
+
+// Times the SSI mode and baud rate were rewritten for a device change
+uint32_t getSpiBusReconfigurations(uint8_t ssi)
+{
+    return buses[ssi].reconfigurations;
+}
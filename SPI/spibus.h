@@ -0,0 +1,77 @@
+// SPI Bus Manager Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Hardware configuration:
+// Any SSI module set up with initSpi(), devices selected by its FSS or by GPIO pins
+
+// The manager assumes it owns the SSI module. A driver that clocks the module
+// directly (the ledpwm.c uDMA stream) must stop before a transaction is
+// queued and restart after it completes, which is what every expander access
+// bracketed by pauseLedPwm()/resumeLedPwm() does. A transaction that finds a
+// direct transfer still running ends with SPI_BUS_BUSY.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SPIBUS_H_
+#define SPIBUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+
+#define SPI_BUS_DEVICES     8               // devices across all modules
+#define SPI_BUS_QUEUE_SIZE  8               // queued transactions per module
+#define SPI_BUS_FSS         0xFF            // csPin selecting the module FSS
+#define SPI_BUS_NO_DEVICE   0xFF
+
+// Transaction priority, higher runs first
+#define SPI_BUS_PRIORITY_THREAD 0
+#define SPI_BUS_PRIORITY_ISR    1
+
+// Transaction status
+#define SPI_BUS_PENDING     0
+#define SPI_BUS_OK          1
+#define SPI_BUS_QUEUE_FULL  2
+#define SPI_BUS_BUSY        3               // SSI held by a transfer outside the manager
+#define SPI_BUS_INVALID     4               // refused before queueing, moves no data
+
+struct _SPI_BUS_TRANSACTION;
+typedef void (*SPI_BUS_CALLBACK)(struct _SPI_BUS_TRANSACTION* transaction);
+
+// Caller owned, must stay valid until status leaves SPI_BUS_PENDING
+// Buffers hold uint8_t frames for devices of up to 8 bits, uint16_t above
+typedef struct _SPI_BUS_TRANSACTION
+{
+    uint8_t device;
+    const void* tx;                         // 0 to send zeros
+    void* rx;                               // 0 to discard
+    uint16_t count;                         // frames
+    uint8_t priority;
+    SPI_BUS_CALLBACK callback;              // runs from the SSI ISR (or the queueing call on SPI_BUS_BUSY), may be 0
+    volatile uint8_t status;
+} SPI_BUS_TRANSACTION;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initSpiBus(uint32_t fcyc);
+uint8_t addSpiDevice(uint8_t ssi, uint8_t polarity, uint8_t phase, uint32_t baudRate, uint8_t bits,
+                     PORT csPort, uint8_t csPin);
+bool queueSpiBusTransaction(SPI_BUS_TRANSACTION* transaction);
+uint8_t waitSpiBusTransaction(SPI_BUS_TRANSACTION* transaction);
+uint8_t runSpiBusTransaction(SPI_BUS_TRANSACTION* transaction);
+uint8_t getSpiBusCallerPriority(void);
+uint32_t getSpiBusReconfigurations(uint8_t ssi);
+
+#endif
@@ -0,0 +1,296 @@
+// Software SPI Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// CLK, TX (MOSI), optional RX (MISO) and optional FSS on any pins of one GPIO port
+
+// Extra SPI chains beyond the four SSI modules, in all four CPOL/CPHA modes.
+// Each pin is written through its own masked DATA aperture (base + (bit << 2)),
+// so a store touches only that pin and needs no read-modify-write. TX is
+// written as 0 or ~0 from the data bit, and RX is read back with a shift, so
+// every bit costs the same number of cycles whatever the data is. The
+// per-frame loop is unrolled, with one routine for each clock phase that is
+// entered at the top bit of the frame size, and the polarity held in the
+// clock level values. Frames are 4 to 16 bits as on the SSI, held in uint8_t
+// buffers up to 8 bits and uint16_t above, so a chain can move between an SSI
+// module and a software bus without changing its buffers.
+//
+// When no baud rate is set the clock runs as fast as the unrolled loop allows.
+// The expected speed at 40 MHz is about 12 cycles per bit on the APB aperture
+// (~3.3 MHz SCK) and about 8 on AHB (~5 MHz). These figures are unmeasured
+// estimates from instruction and bus wait counts, not scope readings;
+// getSwSpiClockRate() reports the rate the last transfer actually achieved
+// and is the number to quote for a given build. With USE_SW_SPI_AHB the whole
+// port moves to the AHB aperture, after which gpio.c calls (and enablePort)
+// must not be used on that port.
+//
+// A baud rate set with setSwSpiBaudRate() switches to a bit loop that times
+// each half period from the DWT cycle counter.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "swspi.h"
+#include "dwt.h"
+
+#define APB_PORTA_BASE      0x40004000
+#define APB_PORTE_BASE      0x40024000
+#define AHB_PORTA_BASE      0x40058000
+#define DATA_OFFSET         0x3FC           // PORT enums alias bit 0 of the full DATA mask
+
+#define APERTURE(base, pin) ((volatile uint32_t *)((uintptr_t)(base) + ((1u << (pin)) << 2)))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _SW_SPI
+{
+    volatile uint32_t* clk;
+    volatile uint32_t* tx;
+    volatile uint32_t* rx;                  // 0 if not used
+    volatile uint32_t* fss;                 // 0 if not used
+    uint8_t rxPin;
+    uint8_t phase;
+    uint32_t clkIdle;                       // 0 or ~0 for the clock polarity
+    uint32_t clkActive;
+    uint32_t halfCycles;                    // 0 for the unrolled loops
+    uint8_t dataSize;                       // bits per frame
+    uint32_t bytes;
+    uint32_t lastBits;
+    uint32_t lastCycles;
+} SW_SPI;
+
+static SW_SPI swSpi[SW_SPI_COUNT];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// APB or AHB base address of the port, from its bit-band alias
+static uint32_t getPortBase(PORT port, bool ahb)
+{
+    uint32_t base = 0x40000000 + ((uint32_t)port - 0x42000000) / 32 - DATA_OFFSET;
+    uint8_t index = base < APB_PORTE_BASE ? (base - APB_PORTA_BASE) >> 12 : 4 + ((base - APB_PORTE_BASE) >> 12);
+
+    if (ahb)
+    {
+        SYSCTL_GPIOHBCTL_R |= 1 << index;
+        return AHB_PORTA_BASE + (index << 12);
+    }
+    return base;
+}
+
+void initSwSpi(uint8_t bus, PORT port, uint8_t clk, uint8_t tx, uint8_t rx, uint8_t fss,
+               uint32_t options)
+{
+    SW_SPI* s = &swSpi[bus];
+    uint32_t base;
+
+    enablePort(port);
+    initCycleCounter();
+    selectPinPushPullOutput(port, clk);
+    selectPinPushPullOutput(port, tx);
+    if (rx != SW_SPI_NO_PIN)
+        selectPinDigitalInput(port, rx);
+    if (fss != SW_SPI_NO_PIN)
+    {
+        setPinValue(port, fss, 1);
+        selectPinPushPullOutput(port, fss);
+    }
+
+    base = getPortBase(port, options & USE_SW_SPI_AHB);
+    s->clk = APERTURE(base, clk);
+    s->tx = APERTURE(base, tx);
+    s->rx = rx != SW_SPI_NO_PIN ? APERTURE(base, rx) : 0;
+    s->fss = fss != SW_SPI_NO_PIN ? APERTURE(base, fss) : 0;
+    s->rxPin = rx != SW_SPI_NO_PIN ? rx : 0;
+    s->halfCycles = 0;
+    s->dataSize = 8;
+    s->bytes = 0;
+    setSwSpiMode(bus, 0, 0);
+}
+
+// clockRate of 0 runs the unrolled loops at full speed
+void setSwSpiBaudRate(uint8_t bus, uint32_t clockRate, uint32_t fcyc)
+{
+    swSpi[bus].halfCycles = clockRate ? fcyc / (2 * clockRate) : 0;
+}
+
+// Selects 4 to 16 bit frames, as setSpiDataSize() does for an SSI module
+void setSwSpiDataSize(uint8_t bus, uint8_t bits)
+{
+    swSpi[bus].dataSize = bits;
+}
+
+void setSwSpiMode(uint8_t bus, uint8_t polarity, uint8_t phase)
+{
+    SW_SPI* s = &swSpi[bus];
+    s->clkIdle = polarity ? ~0u : 0;
+    s->clkActive = ~s->clkIdle;
+    s->phase = phase;
+    *s->clk = s->clkIdle;
+}
+
+// One bit with CPHA=0: data is set up before the leading edge and sampled on it
+#define BIT_PHASE0(n)                                   \
+    case (n) + 1:                                       \
+    *tx = -((uint32_t)(out >> (n)) & 1);                \
+    *clk = active;                                      \
+    in |= ((*rx >> rxPin) & 1) << (n);                  \
+    *clk = idle;
+
+// One bit with CPHA=1: data changes on the leading edge and is sampled on the trailing edge
+#define BIT_PHASE1(n)                                   \
+    case (n) + 1:                                       \
+    *clk = active;                                      \
+    *tx = -((uint32_t)(out >> (n)) & 1);                \
+    *clk = idle;                                        \
+    in |= ((*rx >> rxPin) & 1) << (n);
+
+// The switch enters the unrolled bits at the top bit of the frame and falls through
+static uint16_t transferFramePhase0(SW_SPI* s, uint16_t out)
+{
+    volatile uint32_t* clk = s->clk;
+    volatile uint32_t* tx = s->tx;
+    volatile uint32_t* rx = s->rx;
+    uint32_t active = s->clkActive, idle = s->clkIdle;
+    uint8_t rxPin = s->rxPin;
+    uint32_t in = 0;
+
+    switch (s->dataSize)
+    {
+        BIT_PHASE0(15) BIT_PHASE0(14) BIT_PHASE0(13) BIT_PHASE0(12)
+        BIT_PHASE0(11) BIT_PHASE0(10) BIT_PHASE0(9)  BIT_PHASE0(8)
+        BIT_PHASE0(7)  BIT_PHASE0(6)  BIT_PHASE0(5)  BIT_PHASE0(4)
+        BIT_PHASE0(3)  BIT_PHASE0(2)  BIT_PHASE0(1)  BIT_PHASE0(0)
+    }
+    return in;
+}
+
+static uint16_t transferFramePhase1(SW_SPI* s, uint16_t out)
+{
+    volatile uint32_t* clk = s->clk;
+    volatile uint32_t* tx = s->tx;
+    volatile uint32_t* rx = s->rx;
+    uint32_t active = s->clkActive, idle = s->clkIdle;
+    uint8_t rxPin = s->rxPin;
+    uint32_t in = 0;
+
+    switch (s->dataSize)
+    {
+        BIT_PHASE1(15) BIT_PHASE1(14) BIT_PHASE1(13) BIT_PHASE1(12)
+        BIT_PHASE1(11) BIT_PHASE1(10) BIT_PHASE1(9)  BIT_PHASE1(8)
+        BIT_PHASE1(7)  BIT_PHASE1(6)  BIT_PHASE1(5)  BIT_PHASE1(4)
+        BIT_PHASE1(3)  BIT_PHASE1(2)  BIT_PHASE1(1)  BIT_PHASE1(0)
+    }
+    return in;
+}
+
+static void waitHalfPeriod(uint32_t* edge, uint32_t halfCycles)
+{
+    *edge += halfCycles;
+    while ((int32_t)(DWT_CYCCNT_R - *edge) < 0);
+}
+
+// Rate limited frame, same edge order as the unrolled routines
+static uint16_t transferFrameTimed(SW_SPI* s, uint16_t out)
+{
+    uint32_t edge = DWT_CYCCNT_R;
+    uint32_t in = 0;
+    int8_t n;
+
+    for (n = s->dataSize - 1; n >= 0; n--)
+    {
+        if (!s->phase)
+            *s->tx = -((uint32_t)(out >> n) & 1);
+        waitHalfPeriod(&edge, s->halfCycles);
+        *s->clk = s->clkActive;
+        if (s->phase)
+            *s->tx = -((uint32_t)(out >> n) & 1);
+        else
+            in |= ((*s->rx >> s->rxPin) & 1) << n;
+        waitHalfPeriod(&edge, s->halfCycles);
+        *s->clk = s->clkIdle;
+        if (s->phase)
+            in |= ((*s->rx >> s->rxPin) & 1) << n;
+    }
+    return in;
+}
+
+// Transfers count frames at the current data size, buffers as in startSpiTransfer()
+// tx may be 0 to send zeros, rx may be 0 to discard
+bool startSwSpiTransfer(uint8_t bus, const void* tx, void* rx, uint16_t count,
+                        SPI_CALLBACK callback)
+{
+    SW_SPI* s = &swSpi[bus];
+    volatile uint32_t* rxSave = s->rx;
+    bool wide = s->dataSize > 8;
+    uint32_t rxDummy = 0;
+    uint32_t start;
+    uint16_t i, out, in;
+
+    if (count == 0)
+        return false;
+    if (!s->rx)
+        s->rx = &rxDummy;                   // keeps the unrolled loops free of tests
+    if (s->fss)
+        *s->fss = 0;
+    start = DWT_CYCCNT_R;
+    for (i = 0; i < count; i++)
+    {
+        out = !tx ? 0 : wide ? ((const uint16_t*)tx)[i] : ((const uint8_t*)tx)[i];
+        if (s->halfCycles)
+            in = transferFrameTimed(s, out);
+        else if (s->phase)
+            in = transferFramePhase1(s, out);
+        else
+            in = transferFramePhase0(s, out);
+        if (rx && wide)
+            ((uint16_t*)rx)[i] = in;
+        else if (rx)
+            ((uint8_t*)rx)[i] = in;
+    }
+    s->lastCycles = DWT_CYCCNT_R - start;
+    s->lastBits = s->dataSize * (uint32_t)count;
+    if (s->fss)
+        *s->fss = ~0u;
+    s->rx = rxSave;
+    s->bytes += count * ((s->dataSize + 7) / 8);
+    if (callback)
+        callback(bus);
+    return true;
+}
+
+bool isSwSpiTransferDone(uint8_t bus)
+{
+    return true;
+}
+
+// Bytes moved by completed transfers, for throughput accounting
+uint32_t getSwSpiBytes(uint8_t bus)
+{
+    return swSpi[bus].bytes;
+}
+
+// Average SCK rate of the last transfer, including the per-byte overhead
+uint32_t getSwSpiClockRate(uint8_t bus, uint32_t fcyc)
+{
+    SW_SPI* s = &swSpi[bus];
+    if (!s->lastCycles)
+        return 0;
+    return (uint64_t)s->lastBits * fcyc / s->lastCycles;
+}
@@ -0,0 +1,54 @@
+// Software SPI Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// CLK, TX (MOSI), optional RX (MISO) and optional FSS on any pins of one GPIO port
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef SWSPI_H_
+#define SWSPI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+#include "spi.h"
+
+#define SW_SPI0 0
+#define SW_SPI1 1
+#define SW_SPI2 2
+#define SW_SPI3 3
+#define SW_SPI_COUNT 4
+
+#define SW_SPI_NO_PIN   0xFF                // for rx or fss when not used
+#define USE_SW_SPI_AHB  1                   // move the port to the AHB aperture
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initSwSpi(uint8_t bus, PORT port, uint8_t clk, uint8_t tx, uint8_t rx, uint8_t fss,
+               uint32_t options);
+void setSwSpiBaudRate(uint8_t bus, uint32_t clockRate, uint32_t fcyc);
+void setSwSpiMode(uint8_t bus, uint8_t polarity, uint8_t phase);
+void setSwSpiDataSize(uint8_t bus, uint8_t bits);
+
+// Same interface as the SSI transfers in spi.h; the transfer runs to
+// completion (and the callback has run) before startSwSpiTransfer returns
+bool startSwSpiTransfer(uint8_t bus, const void* tx, void* rx, uint16_t count,
+                        SPI_CALLBACK callback);
+bool isSwSpiTransferDone(uint8_t bus);
+uint32_t getSwSpiBytes(uint8_t bus);
+uint32_t getSwSpiClockRate(uint8_t bus, uint32_t fcyc);
+
+#endif
@@ -0,0 +1,185 @@
+// UART0 Log Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    40 MHz
+
+// Hardware configuration:
+// UART Interface:
+//   U0TX (PA1) and U0RX (PA0) are connected to the 2nd controller
+//   The USB on the 2nd controller enumerates to an ICDI interface and a virtual COM port
+
+// logUart0() may be called from any context. A slot is reserved with
+// LDREX/STREX, filled, and then marked ready, so the cost per call is a few
+// tens of cycles and never waits on the UART. The UART0 ISR drains ready
+// slots in order into the TX FIFO at background priority.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "gpio.h"
+#include "nvic.h"
+#include "dwt.h"
+#include "uart0.h"
+
+// Pins
+#define UART_TX PORTA,1
+#define UART_RX PORTA,0
+
+#define RESERVE_FULL 0xFFFFFFFF
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+typedef struct _LOG_SLOT
+{
+    LOG_RECORD record;
+    volatile uint8_t ready;                 // set by the producer once the record is complete
+} LOG_SLOT;
+
+static LOG_SLOT slots[LOG_SLOTS];
+static volatile uint32_t head;              // next slot to reserve, any producer
+static volatile uint32_t tail;              // next slot to send, ISR only
+static uint8_t offset;                      // bytes of slots[tail] already sent
+static volatile uint32_t dropped;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Atomically claims the next slot unless size slots are already in use
+// tail is re-read inside the exclusive section, so an ISR that moves either
+// index between the read and the STREX clears the monitor and forces a retry
+// Returns the claimed slot (0 to size - 1), or RESERVE_FULL
+// Never inlined: the labels must exist once and BX LR must return from here
+#pragma FUNC_CANNOT_INLINE(reserveSlot)
+static uint32_t reserveSlot(volatile uint32_t* head, volatile uint32_t* tail, uint32_t size)
+{
+    __asm("RSV_RETRY:   LDREX   R3, [R0]\n"
+          "             LDR     R12, [R1]\n"
+          "             SUBS    R12, R3, R12\n"
+          "             CMP     R12, R2\n"
+          "             BHS     RSV_FULL\n"
+          "             ADDS    R3, R3, #1\n"
+          "             STREX   R12, R3, [R0]\n"
+          "             CMP     R12, #0\n"
+          "             BNE     RSV_RETRY\n"
+          "             SUBS    R0, R3, #1\n"
+          "             SUBS    R12, R2, #1\n"
+          "             ANDS    R0, R0, R12\n"
+          "             BX      LR\n"
+          "RSV_FULL:    CLREX\n"
+          "             MVN     R0, #0\n"
+          "             BX      LR");
+    return RESERVE_FULL;                    // not reached, satisfies the compiler
+}
+
+// Atomically adds one to a counter shared by the ISRs and the task
+// Never inlined, for the same reason as reserveSlot
+#pragma FUNC_CANNOT_INLINE(incrementCount)
+static void incrementCount(volatile uint32_t* count)
+{
+    __asm("INC_RETRY:   LDREX   R1, [R0]\n"
+          "             ADDS    R1, R1, #1\n"
+          "             STREX   R2, R1, [R0]\n"
+          "             CMP     R2, #0\n"
+          "             BNE     INC_RETRY\n"
+          "             BX      LR");
+}
+
+// Initialize UART0 and the log buffer
+void initUart0Log(uint32_t baudRate, uint32_t fcyc)
+{
+    uint32_t i;
+    uint32_t divisorTimes128 = (fcyc * 8) / baudRate;    // calculate divisor (r) in units of 1/128
+
+    for (i = 0; i < LOG_SLOTS; i++)
+        slots[i].ready = 0;
+    head = 0;
+    tail = 0;
+    offset = 0;
+    dropped = 0;
+    initCycleCounter();
+
+    // Enable clocks
+    SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R0;
+    _delay_cycles(3);
+    enablePort(PORTA);
+
+    // Configure UART0 pins
+    selectPinPushPullOutput(UART_TX);
+    selectPinDigitalInput(UART_RX);
+    setPinAuxFunction(UART_TX, GPIO_PCTL_PA1_U0TX);
+    setPinAuxFunction(UART_RX, GPIO_PCTL_PA0_U0RX);
+
+    // Configure UART0 with default baud rate
+    UART0_CTL_R = 0;                                     // turn-off UART0 to allow safe programming
+    UART0_CC_R = UART_CC_CS_SYSCLK;                      // use system clock
+    UART0_IBRD_R = divisorTimes128 >> 7;                 // set integer part of divisor
+    UART0_FBRD_R = ((divisorTimes128 + 1) >> 1) & 63;    // round fractional part of divisor
+    UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;     // configure for 8N1 w/ 16-level FIFO
+    UART0_IFLS_R = UART_IFLS_TX1_8;                      // refill when the TX FIFO drops to 1/8
+    UART0_IM_R = UART_IM_TXIM;
+    UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN;
+
+    setNvicInterruptPriority(INT_UART0, PRIORITY_BACKGROUND);
+    enableNvicInterrupt(INT_UART0);
+}
+
+// Queue a record, safe from any ISR or task
+// Returns false (and counts a drop) if the buffer is full
+bool logUart0(uint8_t id, uint16_t arg)
+{
+    uint32_t index = reserveSlot(&head, &tail, LOG_SLOTS);
+    LOG_SLOT* slot;
+    if (index == RESERVE_FULL)
+    {
+        incrementCount(&dropped);
+        return false;
+    }
+    slot = &slots[index];
+    slot->record.sync = LOG_SYNC;
+    slot->record.id = id;
+    slot->record.arg = arg;
+    slot->record.timestamp = DWT_CYCCNT_R;
+    __asm("    DMB");                                    // record complete before it is marked ready
+    slot->ready = 1;
+    setNvicInterruptPending(INT_UART0);                  // kick the drain
+    return true;
+}
+
+uint32_t getUart0LogDropped(void)
+{
+    return dropped;
+}
+
+// Moves ready records into the TX FIFO, in order
+void uart0Isr(void)
+{
+    LOG_SLOT* slot;
+    UART0_ICR_R = UART_ICR_TXIC;
+    while (!(UART0_FR_R & UART_FR_TXFF))
+    {
+        slot = &slots[tail & (LOG_SLOTS - 1)];
+        if (!slot->ready)                                // empty, or a producer is still filling it
+            break;
+        __asm("    DMB");
+        UART0_DR_R = ((uint8_t*)&slot->record)[offset++];
+        if (offset == sizeof(LOG_RECORD))
+        {
+            offset = 0;
+            slot->ready = 0;
+            tail++;                                      // release the slot to producers
+        }
+    }
+}
@@ -0,0 +1,344 @@
+// uDMA Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// The module owns the 1 KiB aligned control table (32 primary and 32
+// alternate structures). Drivers claim a channel and its channel-map source
+// with allocateUdmaChannel() and get a callback on completion.
+// Software and memory transfers complete through the uDMA software vector.
+// Peripheral channels complete through the peripheral's own vector, whose ISR
+// must call serviceUdmaCompletions() with the channel bit.
+// Ping-pong structures are re-armed here before the callback runs, so the
+// callback only has to consume the half that just filled.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "nvic.h"
+#include "udma.h"
+
+#define ALTERNATE               UDMA_CHANNELS       // offset of the alternate structures
+#define CHCTL_MODE_M            0x00000007
+#define CHCTL_COUNT_S           4
+#define CHCTL_ARB_S             14
+#define CHCTL_SRCSIZE_S         24
+#define CHCTL_SRCINC_S          26
+#define CHCTL_DSTSIZE_S         28
+#define CHCTL_DSTINC_S          30
+#define ALT_SG_MODE             1                   // MEM_SG/PER_SG + 1 selects the alternate variant
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#pragma DATA_ALIGN(controlTable, 1024)
+static UDMA_ENTRY controlTable[2 * UDMA_CHANNELS];
+
+static UDMA_CALLBACK callbacks[UDMA_CHANNELS];
+static uint32_t reload[2][UDMA_CHANNELS];          // ping-pong control words
+static uint32_t allocated;
+static uint32_t pingPongChannels;
+static uint32_t softwareChannels;                   // complete through the uDMA software vector
+static volatile uint32_t errors;
+static bool initialized;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Address of the last item described by the control word
+static volatile void* getEndAddress(const volatile void* start, uint32_t control, uint8_t incShift)
+{
+    uint32_t count = ((control & UDMA_CHCTL_XFERSIZE_M) >> CHCTL_COUNT_S) + 1;
+    uint8_t inc = (control >> incShift) & 3;
+    if (inc == UDMA_INC_NONE)
+        return (volatile void*)start;
+    return (volatile void*)((uintptr_t)start + ((count - 1) << inc));
+}
+
+// Initialize the controller, the control table and the completion vectors
+// Only the first call resets the table, so channels claimed afterwards survive
+void initUdma(void)
+{
+    uint8_t i;
+
+    if (initialized)
+        return;
+
+    // Enable clocks
+    SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0;
+    _delay_cycles(3);
+
+    for (i = 0; i < 2 * UDMA_CHANNELS; i++)
+        controlTable[i].control = 0;
+    for (i = 0; i < UDMA_CHANNELS; i++)
+        callbacks[i] = 0;
+    allocated = 0;
+    pingPongChannels = 0;
+    softwareChannels = 0;
+    errors = 0;
+
+    UDMA_CFG_R = UDMA_CFG_MASTEN;
+    UDMA_CTLBASE_R = (uintptr_t)controlTable;
+    UDMA_ENACLR_R = 0xFFFFFFFF;
+    UDMA_CHIS_R = 0xFFFFFFFF;
+    UDMA_ERRCLR_R = UDMA_ERRCLR_ERRCLR;
+
+    setNvicInterruptPriority(INT_UDMA, PRIORITY_BUS);
+    setNvicInterruptPriority(INT_UDMAERR, PRIORITY_BUS);
+    enableNvicInterrupt(INT_UDMA);
+    enableNvicInterrupt(INT_UDMAERR);
+    initialized = true;
+}
+
+// Claims a channel and routes the given source to it (see the encodings in udma.h)
+// Returns false if the channel is already in use or initUdma() has not run yet
+bool allocateUdmaChannel(uint8_t channel, uint8_t encoding, UDMA_CALLBACK callback)
+{
+    volatile uint32_t* map = &UDMA_CHMAP0_R + (channel >> 3);
+    uint8_t shift = (channel & 7) * 4;
+    uint32_t mask = 1 << channel;
+    if (!initialized || (allocated & mask))
+        return false;
+    allocated |= mask;
+    UDMA_ENACLR_R = mask;
+    *map = (*map & ~(0xF << shift)) | ((uint32_t)encoding << shift);
+    UDMA_REQMASKCLR_R = mask;                       // accept peripheral requests
+    UDMA_USEBURSTCLR_R = mask;                      // accept single and burst requests
+    UDMA_ALTCLR_R = mask;
+    UDMA_PRIOCLR_R = mask;
+    UDMA_CHIS_R = mask;
+    callbacks[channel] = callback;
+    return true;
+}
+
+void freeUdmaChannel(uint8_t channel)
+{
+    uint32_t mask = 1 << channel;
+    UDMA_ENACLR_R = mask;
+    UDMA_REQMASKSET_R = mask;
+    callbacks[channel] = 0;
+    pingPongChannels &= ~mask;
+    softwareChannels &= ~mask;
+    allocated &= ~mask;
+}
+
+// Builds a channel control word
+// size is UDMA_SIZE_x for both ends, srcInc/dstInc are UDMA_INC_ITEM or UDMA_INC_NONE,
+// arbLog2 rearbitrates every 2^arbLog2 items, count is 1 to UDMA_MAX_TRANSFER
+uint32_t makeUdmaControl(uint8_t mode, uint8_t size, uint8_t srcInc, uint8_t dstInc,
+                         uint8_t arbLog2, uint16_t count)
+{
+    uint32_t control = mode & CHCTL_MODE_M;
+    control |= (uint32_t)(dstInc == UDMA_INC_NONE ? UDMA_INC_NONE : size) << CHCTL_DSTINC_S;
+    control |= (uint32_t)size << CHCTL_DSTSIZE_S;
+    control |= (uint32_t)(srcInc == UDMA_INC_NONE ? UDMA_INC_NONE : size) << CHCTL_SRCINC_S;
+    control |= (uint32_t)size << CHCTL_SRCSIZE_S;
+    control |= (uint32_t)arbLog2 << CHCTL_ARB_S;
+    control |= ((uint32_t)(count - 1) << CHCTL_COUNT_S) & UDMA_CHCTL_XFERSIZE_M;
+    return control;
+}
+
+// Builds one scatter-gather task
+// Every task but the last is given a MEM_SG or PER_SG control word, which is
+// converted to its alternate variant; the last task uses BASIC or AUTO
+UDMA_ENTRY makeUdmaTask(const volatile void* src, volatile void* dst, uint32_t control)
+{
+    UDMA_ENTRY task;
+    uint8_t mode = control & CHCTL_MODE_M;
+    if (mode == UDMA_MODE_MEM_SG || mode == UDMA_MODE_PER_SG)
+        control += ALT_SG_MODE;
+    task.srcEnd = getEndAddress(src, control, CHCTL_SRCINC_S);
+    task.dstEnd = getEndAddress(dst, control, CHCTL_DSTINC_S);
+    task.control = control;
+    task.spare = 0;
+    return task;
+}
+
+// Writes the primary or alternate structure of a channel
+void setupUdmaTransfer(uint8_t channel, bool alternate, const volatile void* src,
+                       volatile void* dst, uint32_t control)
+{
+    UDMA_ENTRY* entry = &controlTable[channel + (alternate ? ALTERNATE : 0)];
+    entry->srcEnd = getEndAddress(src, control, CHCTL_SRCINC_S);
+    entry->dstEnd = getEndAddress(dst, control, CHCTL_DSTINC_S);
+    entry->control = control;
+    reload[alternate][channel] = control;
+}
+
+// Single transfer of count items, started by peripheral requests or requestUdmaChannel()
+void startUdmaBasic(uint8_t channel, const volatile void* src, volatile void* dst,
+                    uint8_t size, uint8_t srcInc, uint8_t dstInc, uint8_t arbLog2, uint16_t count)
+{
+    uint32_t mask = 1 << channel;
+    pingPongChannels &= ~mask;
+    setupUdmaTransfer(channel, false, src, dst,
+                      makeUdmaControl(UDMA_MODE_BASIC, size, srcInc, dstInc, arbLog2, count));
+    UDMA_ALTCLR_R = mask;
+    UDMA_ENASET_R = mask;
+}
+
+// Memory to memory copy that runs to completion from one software request
+void startUdmaAuto(uint8_t channel, const volatile void* src, volatile void* dst,
+                   uint8_t size, uint16_t count)
+{
+    uint32_t mask = 1 << channel;
+    pingPongChannels &= ~mask;
+    softwareChannels |= mask;
+    setupUdmaTransfer(channel, false, src, dst,
+                      makeUdmaControl(UDMA_MODE_AUTO, size, UDMA_INC_ITEM, UDMA_INC_ITEM, 3, count));
+    UDMA_ALTCLR_R = mask;
+    UDMA_ENASET_R = mask;
+    UDMA_SWREQ_R = mask;
+}
+
+// Continuous peripheral to memory stream alternating between dst0 and dst1
+// The source address does not increment (peripheral FIFO)
+void startUdmaPingPong(uint8_t channel, const volatile void* src,
+                       volatile void* dst0, volatile void* dst1,
+                       uint8_t size, uint8_t arbLog2, uint16_t count)
+{
+    uint32_t mask = 1 << channel;
+    uint32_t control = makeUdmaControl(UDMA_MODE_PINGPONG, size, UDMA_INC_NONE, UDMA_INC_ITEM,
+                                       arbLog2, count);
+    pingPongChannels |= mask;
+    setupUdmaTransfer(channel, false, src, dst0, control);
+    setupUdmaTransfer(channel, true, src, dst1, control);
+    UDMA_ALTCLR_R = mask;
+    UDMA_ENASET_R = mask;
+}
+
+// Continuous memory to peripheral stream alternating between src0 and src1
+// The destination address does not increment (peripheral FIFO)
+void startUdmaPingPongTx(uint8_t channel, const volatile void* src0, const volatile void* src1,
+                         volatile void* dst, uint8_t size, uint8_t arbLog2, uint16_t count)
+{
+    uint32_t mask = 1 << channel;
+    uint32_t control = makeUdmaControl(UDMA_MODE_PINGPONG, size, UDMA_INC_ITEM, UDMA_INC_NONE,
+                                       arbLog2, count);
+    pingPongChannels |= mask;
+    setupUdmaTransfer(channel, false, src0, dst, control);
+    setupUdmaTransfer(channel, true, src1, dst, control);
+    UDMA_ALTCLR_R = mask;
+    UDMA_ENASET_R = mask;
+}
+
+// Runs a task list built with makeUdmaTask()
+// The primary structure copies each task into the alternate structure, which
+// then executes it; peripheral lists advance on peripheral requests
+void startUdmaScatterGather(uint8_t channel, bool peripheral, const UDMA_ENTRY* tasks,
+                            uint8_t taskCount)
+{
+    uint32_t mask = 1 << channel;
+    pingPongChannels &= ~mask;
+    setupUdmaTransfer(channel, false, tasks, &controlTable[channel + ALTERNATE],
+                      makeUdmaControl(peripheral ? UDMA_MODE_PER_SG : UDMA_MODE_MEM_SG,
+                                      UDMA_SIZE_32, UDMA_INC_ITEM, UDMA_INC_ITEM, 2,
+                                      taskCount * sizeof(UDMA_ENTRY) / sizeof(uint32_t)));
+    controlTable[channel].dstEnd = &controlTable[channel + ALTERNATE].spare;  // rewrites one task at a time
+    UDMA_ALTCLR_R = mask;
+    UDMA_ENASET_R = mask;
+    if (!peripheral)
+    {
+        softwareChannels |= mask;
+        UDMA_SWREQ_R = mask;
+    }
+}
+
+void enableUdmaChannel(uint8_t channel)
+{
+    UDMA_ENASET_R = 1 << channel;
+}
+
+void disableUdmaChannel(uint8_t channel)
+{
+    UDMA_ENACLR_R = 1 << channel;
+}
+
+bool isUdmaChannelEnabled(uint8_t channel)
+{
+    return (UDMA_ENASET_R >> channel) & 1;
+}
+
+// Software request, completion is reported through the uDMA software vector
+void requestUdmaChannel(uint8_t channel)
+{
+    uint32_t mask = 1 << channel;
+    softwareChannels |= mask;
+    UDMA_SWREQ_R = mask;
+}
+
+// Items left in a structure, 0 once it has completed
+uint16_t getUdmaRemaining(uint8_t channel, bool alternate)
+{
+    uint32_t control = controlTable[channel + (alternate ? ALTERNATE : 0)].control;
+    if ((control & CHCTL_MODE_M) == UDMA_MODE_STOP)
+        return 0;
+    return ((control & UDMA_CHCTL_XFERSIZE_M) >> CHCTL_COUNT_S) + 1;
+}
+
+uint32_t getUdmaErrors(void)
+{
+    return errors;
+}
+
+// Re-arms a finished ping-pong half and reports it
+static void completePingPongHalf(uint8_t channel, bool alternate)
+{
+    UDMA_ENTRY* entry = &controlTable[channel + (alternate ? ALTERNATE : 0)];
+    if ((entry->control & CHCTL_MODE_M) != UDMA_MODE_STOP)
+        return;
+    entry->control = reload[alternate][channel];
+    if (callbacks[channel])
+        callbacks[channel](channel, alternate);
+}
+
+// Dispatches completed channels in channelMask
+// Called from udmaIsr() and from peripheral ISRs that own uDMA channels
+void serviceUdmaCompletions(uint32_t channelMask)
+{
+    uint32_t done = UDMA_CHIS_R & channelMask;
+    uint8_t channel;
+    UDMA_CHIS_R = done;
+    for (channel = 0; done; channel++, done >>= 1)
+    {
+        if (!(done & 1))
+            continue;
+        if (pingPongChannels & (1 << channel))
+        {
+            // The half that is not active now finished first
+            bool active = (UDMA_ALTSET_R >> channel) & 1;
+            completePingPongHalf(channel, !active);
+            completePingPongHalf(channel, active);
+        }
+        else if (callbacks[channel])
+            callbacks[channel](channel, (UDMA_ALTSET_R >> channel) & 1);
+    }
+}
+
+// uDMA software vector, completion of software and memory transfers
+void udmaIsr(void)
+{
+    serviceUdmaCompletions(softwareChannels);
+}
+
+// uDMA error vector, a bus error stops the channel that caused it
+void udmaErrorIsr(void)
+{
+    if (UDMA_ERRCLR_R)
+    {
+        UDMA_ERRCLR_R = UDMA_ERRCLR_ERRCLR;
+        errors++;
+    }
+}
@@ -0,0 +1,121 @@
+// uDMA Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef UDMA_H_
+#define UDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+
+#define UDMA_CHANNELS       32
+#define UDMA_MAX_TRANSFER   1024                // items per structure (XFERSIZE + 1)
+
+// Channel map encodings (datasheet table 9-1), pass with the channel number
+// to allocateUdmaChannel()
+#define UDMA_CH4_GPIOA      3
+#define UDMA_CH4_TIMER2A    1
+#define UDMA_CH7_GPIOD      3
+#define UDMA_CH8_UART0RX    0
+#define UDMA_CH9_UART0TX    0
+#define UDMA_CH10_SSI0RX    0
+#define UDMA_CH11_SSI0TX    0
+#define UDMA_CH10_SSI1RX    1
+#define UDMA_CH11_SSI1TX    1
+#define UDMA_CH10_WTIMER0A  3
+#define UDMA_CH12_SSI2RX    2
+#define UDMA_CH13_SSI2TX    2
+#define UDMA_CH14_ADC0SS0   0
+#define UDMA_CH14_SSI3RX    2
+#define UDMA_CH15_SSI3TX    2
+#define UDMA_CH17_ADC0SS3   0
+#define UDMA_CH18_TIMER0A   0
+#define UDMA_CH18_TIMER1A   1
+#define UDMA_CH24_SSI1RX    0
+#define UDMA_CH25_SSI1TX    0
+#define UDMA_CH24_ADC1SS0   1
+#define UDMA_CH27_ADC1SS3   1
+#define UDMA_CH30_SOFTWARE  0
+
+// Item size, applies to both source and destination
+#define UDMA_SIZE_8         0
+#define UDMA_SIZE_16        1
+#define UDMA_SIZE_32        2
+
+// Address increment, in units of the item size or none
+#define UDMA_INC_ITEM       0
+#define UDMA_INC_NONE       3
+
+// Transfer modes (CHCTL XFERMODE)
+#define UDMA_MODE_STOP      0
+#define UDMA_MODE_BASIC     1
+#define UDMA_MODE_AUTO      2
+#define UDMA_MODE_PINGPONG  3
+#define UDMA_MODE_MEM_SG    4
+#define UDMA_MODE_PER_SG    6
+
+// Completion handler, alternate is true when the alternate structure finished
+typedef void (*UDMA_CALLBACK)(uint8_t channel, bool alternate);
+
+// One control structure, also the format of a scatter-gather task
+typedef struct _UDMA_ENTRY
+{
+    volatile void* srcEnd;                      // address of the last source item
+    volatile void* dstEnd;                      // address of the last destination item
+    volatile uint32_t control;
+    uint32_t spare;
+} UDMA_ENTRY;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// initUdma() must run before any driver claims a channel (initSpi with
+// USE_SSI_DMA, startAdcStream, initLedPwm); allocateUdmaChannel() refuses
+// until it has. Later calls to initUdma() are ignored.
+void initUdma(void);
+bool allocateUdmaChannel(uint8_t channel, uint8_t encoding, UDMA_CALLBACK callback);
+void freeUdmaChannel(uint8_t channel);
+
+uint32_t makeUdmaControl(uint8_t mode, uint8_t size, uint8_t srcInc, uint8_t dstInc,
+                         uint8_t arbLog2, uint16_t count);
+UDMA_ENTRY makeUdmaTask(const volatile void* src, volatile void* dst, uint32_t control);
+
+void setupUdmaTransfer(uint8_t channel, bool alternate, const volatile void* src,
+                       volatile void* dst, uint32_t control);
+void startUdmaBasic(uint8_t channel, const volatile void* src, volatile void* dst,
+                    uint8_t size, uint8_t srcInc, uint8_t dstInc, uint8_t arbLog2, uint16_t count);
+void startUdmaAuto(uint8_t channel, const volatile void* src, volatile void* dst,
+                   uint8_t size, uint16_t count);
+void startUdmaPingPong(uint8_t channel, const volatile void* src,
+                       volatile void* dst0, volatile void* dst1,
+                       uint8_t size, uint8_t arbLog2, uint16_t count);
+void startUdmaPingPongTx(uint8_t channel, const volatile void* src0, const volatile void* src1,
+                         volatile void* dst, uint8_t size, uint8_t arbLog2, uint16_t count);
+void startUdmaScatterGather(uint8_t channel, bool peripheral, const UDMA_ENTRY* tasks,
+                            uint8_t taskCount);
+
+void enableUdmaChannel(uint8_t channel);
+void disableUdmaChannel(uint8_t channel);
+bool isUdmaChannelEnabled(uint8_t channel);
+void requestUdmaChannel(uint8_t channel);
+uint16_t getUdmaRemaining(uint8_t channel, bool alternate);
+uint32_t getUdmaErrors(void);
+
+void serviceUdmaCompletions(uint32_t channelMask);
+void udmaIsr(void);
+void udmaErrorIsr(void);
+
+#endif
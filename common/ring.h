@@ -0,0 +1,231 @@
+// Ring Buffer Library
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target Platform: EK-TM4C123GXL
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Shared by the SPI and I2C projects, included as "../common/ring.h"
+//
+// Single-producer/single-consumer ring buffers for passing data from an ISR
+// to the main loop (or back) without disabling interrupts.
+// - Size is a power of 2, head and tail are free-running 32-bit indices
+// - Only the producer writes head, only the consumer writes tail
+// - A DMB orders the data accesses against the index update, so the other
+//   side never sees an index before the data it covers
+// Byte rings (RING_BUFFER) and fixed-size record rings (RECORD_RING) are
+// provided, each with single and batch push/pop
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef RING_H_
+#define RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__TI_ARM__)
+#define RING_BARRIER() __asm("    DMB")
+#elif defined(__arm__)
+#define RING_BARRIER() __asm volatile ("dmb" ::: "memory")
+#else
+#define RING_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)  // host builds, see tools/ring_stress.c
+#endif
+
+typedef struct _RING_BUFFER
+{
+    volatile uint32_t head;                 // next byte to write, producer only
+    volatile uint32_t tail;                 // next byte to read, consumer only
+    uint32_t mask;                          // size - 1
+    volatile uint8_t* data;
+} RING_BUFFER;
+
+typedef struct _RECORD_RING
+{
+    volatile uint32_t head;                 // next record to write, producer only
+    volatile uint32_t tail;                 // next record to read, consumer only
+    uint32_t mask;                          // record count - 1
+    uint32_t recordSize;                    // bytes per record
+    volatile uint8_t* data;
+} RECORD_RING;
+
+//-----------------------------------------------------------------------------
+// Byte ring
+//-----------------------------------------------------------------------------
+
+// size must be a power of 2
+static inline void initRing(RING_BUFFER* ring, uint8_t storage[], uint32_t size)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = size - 1;
+    ring->data = storage;
+}
+
+static inline uint32_t getRingCount(const RING_BUFFER* ring)
+{
+    return ring->head - ring->tail;
+}
+
+static inline uint32_t getRingSpace(const RING_BUFFER* ring)
+{
+    return ring->mask + 1 - (ring->head - ring->tail);
+}
+
+static inline bool pushRing(RING_BUFFER* ring, uint8_t value)
+{
+    uint32_t head = ring->head;
+    if (head - ring->tail > ring->mask)
+        return false;
+    ring->data[head & ring->mask] = value;
+    RING_BARRIER();                         // data visible before the new head
+    ring->head = head + 1;
+    return true;
+}
+
+static inline bool popRing(RING_BUFFER* ring, uint8_t* value)
+{
+    uint32_t tail = ring->tail;
+    if (ring->head == tail)
+        return false;
+    RING_BARRIER();                         // head read before the data it covers
+    *value = ring->data[tail & ring->mask];
+    RING_BARRIER();                         // data read before the slot is released
+    ring->tail = tail + 1;
+    return true;
+}
+
+// Pushes up to size bytes, returns the number pushed
+static inline uint32_t pushRingBatch(RING_BUFFER* ring, const uint8_t data[], uint32_t size)
+{
+    uint32_t head = ring->head;
+    uint32_t space = ring->mask + 1 - (head - ring->tail);
+    uint32_t i;
+    if (size > space)
+        size = space;
+    for (i = 0; i < size; i++)
+        ring->data[(head + i) & ring->mask] = data[i];
+    RING_BARRIER();
+    ring->head = head + size;
+    return size;
+}
+
+// Pops up to size bytes, returns the number popped
+static inline uint32_t popRingBatch(RING_BUFFER* ring, uint8_t data[], uint32_t size)
+{
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+    uint32_t i;
+    if (size > count)
+        size = count;
+    RING_BARRIER();
+    for (i = 0; i < size; i++)
+        data[i] = ring->data[(tail + i) & ring->mask];
+    RING_BARRIER();
+    ring->tail = tail + size;
+    return size;
+}
+
+//-----------------------------------------------------------------------------
+// Record ring
+//-----------------------------------------------------------------------------
+
+// count must be a power of 2, storage must hold count * recordSize bytes
+static inline void initRecordRing(RECORD_RING* ring, void* storage, uint32_t count, uint32_t recordSize)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = count - 1;
+    ring->recordSize = recordSize;
+    ring->data = storage;
+}
+
+static inline uint32_t getRecordRingCount(const RECORD_RING* ring)
+{
+    return ring->head - ring->tail;
+}
+
+static inline uint32_t getRecordRingSpace(const RECORD_RING* ring)
+{
+    return ring->mask + 1 - (ring->head - ring->tail);
+}
+
+static inline void copyToRecordRing(RECORD_RING* ring, uint32_t index, const uint8_t* record)
+{
+    volatile uint8_t* p = ring->data + (index & ring->mask) * ring->recordSize;
+    uint32_t i;
+    for (i = 0; i < ring->recordSize; i++)
+        p[i] = record[i];
+}
+
+static inline void copyFromRecordRing(const RECORD_RING* ring, uint32_t index, uint8_t* record)
+{
+    const volatile uint8_t* p = ring->data + (index & ring->mask) * ring->recordSize;
+    uint32_t i;
+    for (i = 0; i < ring->recordSize; i++)
+        record[i] = p[i];
+}
+
+static inline bool pushRecordRing(RECORD_RING* ring, const void* record)
+{
+    uint32_t head = ring->head;
+    if (head - ring->tail > ring->mask)
+        return false;
+    copyToRecordRing(ring, head, record);
+    RING_BARRIER();
+    ring->head = head + 1;
+    return true;
+}
+
+static inline bool popRecordRing(RECORD_RING* ring, void* record)
+{
+    uint32_t tail = ring->tail;
+    if (ring->head == tail)
+        return false;
+    RING_BARRIER();
+    copyFromRecordRing(ring, tail, record);
+    RING_BARRIER();
+    ring->tail = tail + 1;
+    return true;
+}
+
+// Pushes up to count records, returns the number pushed
+static inline uint32_t pushRecordRingBatch(RECORD_RING* ring, const void* records, uint32_t count)
+{
+    const uint8_t* record = records;
+    uint32_t head = ring->head;
+    uint32_t space = ring->mask + 1 - (head - ring->tail);
+    uint32_t i;
+    if (count > space)
+        count = space;
+    for (i = 0; i < count; i++, record += ring->recordSize)
+        copyToRecordRing(ring, head + i, record);
+    RING_BARRIER();
+    ring->head = head + count;
+    return count;
+}
+
+// Pops up to count records, returns the number popped
+static inline uint32_t popRecordRingBatch(RECORD_RING* ring, void* records, uint32_t count)
+{
+    uint8_t* record = records;
+    uint32_t tail = ring->tail;
+    uint32_t available = ring->head - tail;
+    uint32_t i;
+    if (count > available)
+        count = available;
+    RING_BARRIER();
+    for (i = 0; i < count; i++, record += ring->recordSize)
+        copyFromRecordRing(ring, tail + i, record);
+    RING_BARRIER();
+    ring->tail = tail + count;
+    return count;
+}
+
+#endif
@@ -0,0 +1,207 @@
+// ITM Trace Decoder
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Builds on Linux with any C99 compiler:
+//   gcc -O2 -o itm_decode itm_decode.c
+// Usage:
+//   itm_decode [-f clock_hz] capture.bin
+// capture.bin is the raw SWO byte stream (UART/NRZ encoding, formatter
+// bypassed) as recorded by the probe or a USB-serial adapter on PC3.
+// Prints one line per event with the unwrapped cycle count, the time in
+// microseconds, and the duration of completed ISR, SPI and I2C intervals.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Stimulus port assignment, see itm.h
+#define ITM_PORT_TEXT       0
+#define ITM_PORT_SPI_START  1
+#define ITM_PORT_SPI_STOP   2
+#define ITM_PORT_I2C_START  3
+#define ITM_PORT_I2C_STOP   4
+#define ITM_PORT_ISR_ENTER  8
+#define ITM_PORT_ISR_EXIT   16
+#define ITM_ISR_COUNT       8
+
+#define DEFAULT_CLOCK       40000000.0
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static double clockHz = DEFAULT_CLOCK;
+static uint64_t lastCycles;                 // unwrapped cycle count of the last event
+static bool haveCycles;
+static uint64_t spiStart, i2cStart, isrEnter[ITM_ISR_COUNT];
+static bool spiOpen, i2cOpen, isrOpen[ITM_ISR_COUNT];
+static unsigned long events, overflows;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Extend the 32-bit DWT stamp, assuming events are less than one wrap apart
+static uint64_t unwrapCycles(uint32_t stamp)
+{
+    if (!haveCycles)
+    {
+        lastCycles = stamp;
+        haveCycles = true;
+    }
+    else
+        lastCycles += (uint32_t)(stamp - (uint32_t)lastCycles);
+    return lastCycles;
+}
+
+static void printEvent(uint64_t cycles, const char* name, int id, bool open, uint64_t start)
+{
+    printf("%14llu %14.3f  %-10s", (unsigned long long)cycles, cycles * 1e6 / clockHz, name);
+    if (id >= 0)
+        printf(" %d", id);
+    if (open)
+        printf("  duration %llu cycles (%.3f us)", (unsigned long long)(cycles - start),
+               (cycles - start) * 1e6 / clockHz);
+    printf("\n");
+}
+
+static void decodeEvent(uint8_t port, uint32_t value, uint8_t size)
+{
+    uint64_t cycles;
+
+    if (port == ITM_PORT_TEXT)
+    {
+        uint8_t i;
+        for (i = 0; i < size; i++)
+            putchar((value >> (8 * i)) & 0xFF);
+        return;
+    }
+    if (size != 4)
+        return;                                  // events are always 32-bit writes
+
+    events++;
+    cycles = unwrapCycles(value);
+    if (port == ITM_PORT_SPI_START)
+    {
+        spiStart = cycles;
+        spiOpen = true;
+        printEvent(cycles, "SPI start", -1, false, 0);
+    }
+    else if (port == ITM_PORT_SPI_STOP)
+    {
+        printEvent(cycles, "SPI stop", -1, spiOpen, spiStart);
+        spiOpen = false;
+    }
+    else if (port == ITM_PORT_I2C_START)
+    {
+        i2cStart = cycles;
+        i2cOpen = true;
+        printEvent(cycles, "I2C start", -1, false, 0);
+    }
+    else if (port == ITM_PORT_I2C_STOP)
+    {
+        printEvent(cycles, "I2C stop", -1, i2cOpen, i2cStart);
+        i2cOpen = false;
+    }
+    else if (port >= ITM_PORT_ISR_ENTER && port < ITM_PORT_ISR_ENTER + ITM_ISR_COUNT)
+    {
+        uint8_t isr = port - ITM_PORT_ISR_ENTER;
+        isrEnter[isr] = cycles;
+        isrOpen[isr] = true;
+        printEvent(cycles, "ISR enter", isr, false, 0);
+    }
+    else if (port >= ITM_PORT_ISR_EXIT && port < ITM_PORT_ISR_EXIT + ITM_ISR_COUNT)
+    {
+        uint8_t isr = port - ITM_PORT_ISR_EXIT;
+        printEvent(cycles, "ISR exit", isr, isrOpen[isr], isrEnter[isr]);
+        isrOpen[isr] = false;
+    }
+    else
+        printEvent(cycles, "port", port, false, 0);
+}
+
+// Walk the ITM packet stream
+// Instrumentation packets are decoded, every other packet type is skipped
+static void decodeStream(FILE* f)
+{
+    int c;
+    bool inSync = false;
+    while ((c = fgetc(f)) != EOF)
+    {
+        uint8_t header = c;
+        if (header == 0x00)                      // synchronization, runs of zeros then 0x80
+        {
+            inSync = true;
+            continue;
+        }
+        if (inSync)
+        {
+            inSync = false;
+            if (header == 0x80)
+                continue;
+        }
+        if (header == 0x70)                      // overflow, packets were lost
+        {
+            overflows++;
+            printf("%14s %14s  overflow\n", "-", "-");
+            continue;
+        }
+        if ((header & 0x03) == 0)                // timestamp and extension packets
+        {
+            if (header & 0x80)
+                while ((c = fgetc(f)) != EOF && (c & 0x80));
+            continue;
+        }
+        {
+            uint8_t size = (header & 0x03) == 3 ? 4 : (header & 0x03);
+            uint32_t value = 0;
+            uint8_t i;
+            for (i = 0; i < size; i++)
+            {
+                if ((c = fgetc(f)) == EOF)
+                    return;
+                value |= (uint32_t)c << (8 * i);
+            }
+            if (!(header & 0x04))                // software source (ITM stimulus port)
+                decodeEvent(header >> 3, value, size);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* f;
+    int arg = 1;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-f") == 0)
+    {
+        clockHz = atof(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg >= argc || clockHz <= 0)
+    {
+        fprintf(stderr, "usage: %s [-f clock_hz] capture.bin\n", argv[0]);
+        return 1;
+    }
+    f = fopen(argv[arg], "rb");
+    if (f == NULL)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+    printf("%14s %14s  event\n", "cycles", "time (us)");
+    decodeStream(f);
+    fclose(f);
+    printf("%lu events, %lu overflows\n", events, overflows);
+    return 0;
+}
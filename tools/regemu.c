@@ -0,0 +1,458 @@
+// TM4C123 Register Emulator
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Host:            Linux on x86-64, GCC
+// See regemu.h for the build line and limits.
+//
+// Access path:
+//   The driver touches a register page mapped PROT_NONE and takes SIGSEGV.
+//   The handler loads the register value (after the read hook) into the page,
+//   opens it and sets the trap flag so the instruction runs once. SIGTRAP then
+//   copies the page back, runs the write hook if the access was a store and
+//   closes the page again.
+//   Bit-band alias words are translated to the target register and bit, the
+//   alias page holds the single bit while the instruction runs.
+//   SRAM bit-band aliases resolve to host memory at 0x20000000, where the
+//   host program places its data with -Wl,-Tdata=0x20000000, so a driver that
+//   bit-bands its own variables (wd0.c) works unmodified. These accesses go
+//   straight to the variable and are not counted.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "regemu.h"
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "regemu.c needs Linux on x86-64 (page fault error code and trap flag)"
+#endif
+
+// gregs[] indices from <sys/ucontext.h>, hidden when regemu.h is force
+// included ahead of _GNU_SOURCE
+#ifndef REG_ERR
+#define REG_EFL                 17
+#define REG_ERR                 19
+#endif
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+#define PAGE_SIZE               4096
+#define PF_WRITE                0x2         // page fault error code, write access
+#define EFLAGS_TF               0x100       // trap flag
+
+// Address map
+#define PERIPH_BASE             0x40000000  // APB/AHB peripherals, SYSCTL, uDMA
+#define PERIPH_SIZE             0x00100000
+#define BITBAND_BASE            0x42000000  // alias of PERIPH_BASE
+#define BITBAND_SIZE            0x02000000
+#define PPB_BASE                0xE0000000  // ITM, DWT, NVIC, SCB
+#define PPB_SIZE                0x00100000
+#define SRAM_BASE               0x20000000  // host .data/.bss, see -Tdata
+#define SRAM_BITBAND_BASE       0x22000000  // alias of SRAM_BASE
+
+// Registers with a default model, see installDefaultHooks()
+#define DWT_CYCCNT              0xE0001004
+#define HIB_CTL                 0x400FC010
+#define HIB_CTL_WRC             0x80000000
+#define SSI_SR_OFFSET           0x00C
+#define SSI_SR_TNF              0x00000002
+#define SSI_SR_TFE              0x00000001
+
+#define MAX_HOOKS               64
+
+typedef struct _REGION
+{
+    uint32_t base;
+    uint32_t size;
+    uint32_t* values;                       // simulated register file
+    uint32_t* reads;
+    uint32_t* writes;
+} REGION;
+
+typedef struct _HOOK
+{
+    uint32_t address;
+    REG_READ_HOOK readHook;
+    REG_WRITE_HOOK writeHook;
+} HOOK;
+
+// Access in flight between the fault and the trap
+typedef struct _PENDING
+{
+    bool active;
+    bool write;
+    bool bitband;
+    bool sram;                              // bit-band of host memory, not a register
+    uint8_t bit;
+    uint32_t address;                       // register word
+    uint32_t old;
+    volatile uint32_t* page;                // page opened for the instruction
+    volatile uint32_t* word;                // word the instruction touches
+} PENDING;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static REGION regions[] =
+{
+    {PERIPH_BASE, PERIPH_SIZE, NULL, NULL, NULL},
+    {PPB_BASE,    PPB_SIZE,    NULL, NULL, NULL},
+};
+#define REGION_COUNT (sizeof(regions) / sizeof(regions[0]))
+
+static HOOK hooks[MAX_HOOKS];
+static uint8_t hookCount;
+static PENDING pending;
+static uint32_t totalReads, totalWrites;
+static bool initialized;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static REGION* findRegion(uint32_t address)
+{
+    uint8_t i;
+    for (i = 0; i < REGION_COUNT; i++)
+        if (address - regions[i].base < regions[i].size)
+            return &regions[i];
+    return NULL;
+}
+
+static HOOK* findHook(uint32_t address)
+{
+    uint8_t i;
+    for (i = 0; i < hookCount; i++)
+        if (hooks[i].address == address)
+            return &hooks[i];
+    return NULL;
+}
+
+static void fail(const char* message)
+{
+    // Only async-signal-safe calls, this can run inside the fault handler
+    write(STDERR_FILENO, "regemu: ", 8);
+    write(STDERR_FILENO, message, strlen(message));
+    write(STDERR_FILENO, "\n", 1);
+    _exit(1);
+}
+
+static bool mapRange(uint32_t base, uint32_t size)
+{
+    void* p = mmap((void*)(uintptr_t)base, size, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+    return p == (void*)(uintptr_t)base;
+}
+
+static volatile uint32_t* openPage(uintptr_t address)
+{
+    volatile uint32_t* page = (volatile uint32_t*)(address & ~(uintptr_t)(PAGE_SIZE - 1));
+    if (mprotect((void*)page, PAGE_SIZE, PROT_READ | PROT_WRITE) != 0)
+        fail("mprotect failed");
+    return page;
+}
+
+static uint32_t readRegister(uint32_t address)
+{
+    REGION* region = findRegion(address);
+    uint32_t index = (address - region->base) >> 2;
+    HOOK* hook = findHook(address);
+    uint32_t value = region->values[index];
+    if (hook && hook->readHook)
+        value = hook->readHook(address, value);
+    region->reads[index]++;
+    totalReads++;
+    return value;
+}
+
+static void writeRegister(uint32_t address, uint32_t old, uint32_t value)
+{
+    REGION* region = findRegion(address);
+    uint32_t index = (address - region->base) >> 2;
+    HOOK* hook = findHook(address);
+    if (hook && hook->writeHook)
+        value = hook->writeHook(address, old, value);
+    region->values[index] = value;
+    region->writes[index]++;
+    totalWrites++;
+}
+
+static void faultHandler(int sig, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = context;
+    uintptr_t address = (uintptr_t)info->si_addr;
+    REGION* region;
+    uint32_t offset, value;
+
+    if (pending.active)
+        fail("instruction touches two register pages");
+    if ((address >> 32) || (address - BITBAND_BASE >= BITBAND_SIZE
+                            && address - SRAM_BITBAND_BASE >= BITBAND_SIZE && !findRegion(address)))
+        fail("fault outside the emulated address map");
+
+    pending.write = (uc->uc_mcontext.gregs[REG_ERR] & PF_WRITE) != 0;
+    pending.page = openPage(address);
+    pending.word = (volatile uint32_t*)(address & ~(uintptr_t)3);
+    pending.bitband = false;
+    pending.sram = false;
+
+    if (address - SRAM_BITBAND_BASE < BITBAND_SIZE)
+    {
+        // Alias word n maps to bit (n % 8) of byte (n / 8)
+        offset = (address - SRAM_BITBAND_BASE) >> 2;
+        pending.sram = true;
+        pending.address = SRAM_BASE + ((offset >> 3) & ~3u);
+        pending.bit = (((offset >> 3) & 3) << 3) | (offset & 7);
+        if (msync((void*)(uintptr_t)(pending.address & ~(PAGE_SIZE - 1)), PAGE_SIZE, MS_ASYNC) != 0)
+            fail("SRAM bit-band target is not mapped, link with -no-pie -Wl,-Tdata=0x20000000");
+        pending.old = *(volatile uint32_t*)(uintptr_t)pending.address;
+        *pending.word = (pending.old >> pending.bit) & 1;
+    }
+    else if (address - BITBAND_BASE < BITBAND_SIZE)
+    {
+        offset = (address - BITBAND_BASE) >> 2;
+        pending.bitband = true;
+        pending.address = PERIPH_BASE + ((offset >> 3) & ~3u);
+        pending.bit = (((offset >> 3) & 3) << 3) | (offset & 7);
+        region = findRegion(pending.address);
+        pending.old = region->values[(pending.address - region->base) >> 2];
+        value = pending.write ? pending.old : readRegister(pending.address);
+        *pending.word = (value >> pending.bit) & 1;
+    }
+    else
+    {
+        pending.address = (uint32_t)address & ~3u;
+        region = findRegion(pending.address);
+        pending.old = region->values[(pending.address - region->base) >> 2];
+        *pending.word = pending.write ? pending.old : readRegister(pending.address);
+    }
+
+    pending.active = true;
+    uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+static void trapHandler(int sig, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = context;
+    uint32_t value;
+
+    if (!pending.active)
+        return;
+    uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+
+    if (pending.write && pending.sram)
+    {
+        // Single bit update, the word may have changed since the fault
+        volatile uint32_t* target = (volatile uint32_t*)(uintptr_t)pending.address;
+        if (*pending.word & 1)
+            __atomic_fetch_or(target, 1u << pending.bit, __ATOMIC_SEQ_CST);
+        else
+            __atomic_fetch_and(target, ~(1u << pending.bit), __ATOMIC_SEQ_CST);
+    }
+    else if (pending.write)
+    {
+        value = *pending.word;
+        if (pending.bitband)
+            value = (pending.old & ~(1u << pending.bit)) | ((value & 1) << pending.bit);
+        writeRegister(pending.address, pending.old, value);
+    }
+    *pending.word = 0;
+    if (mprotect((void*)pending.page, PAGE_SIZE, PROT_NONE) != 0)
+        fail("mprotect failed");
+    pending.active = false;
+}
+
+// Default register models, enough for the polling loops in the drivers
+static uint32_t cycleCounterRead(uint32_t address, uint32_t value)
+{
+    value += REGEMU_CYCCNT_STEP;
+    pokeRegEmu(address, value);
+    return value;
+}
+
+static uint32_t ssiStatusRead(uint32_t address, uint32_t value)
+{
+    // Transfers complete at once, TX FIFO empty and not busy, RX FIFO empty
+    return SSI_SR_TNF | SSI_SR_TFE;
+}
+
+static uint32_t hibernationControlRead(uint32_t address, uint32_t value)
+{
+    return value | HIB_CTL_WRC;
+}
+
+static void installDefaultHooks(void)
+{
+    uint8_t ssi;
+    hookCount = 0;
+    setRegEmuHooks(DWT_CYCCNT, cycleCounterRead, NULL);
+    setRegEmuHooks(HIB_CTL, hibernationControlRead, NULL);
+    for (ssi = 0; ssi < 4; ssi++)
+        setRegEmuHooks(0x40008000 + 0x1000 * ssi + SSI_SR_OFFSET, ssiStatusRead, NULL);
+}
+
+// Maps the register ranges and installs the fault handlers, returns false if
+// an address range is already in use by the host process
+bool initRegEmu(void)
+{
+    struct sigaction action;
+    uint8_t i;
+
+    if (initialized)
+        return true;
+    if (!mapRange(PERIPH_BASE, PERIPH_SIZE) || !mapRange(BITBAND_BASE, BITBAND_SIZE)
+        || !mapRange(SRAM_BITBAND_BASE, BITBAND_SIZE) || !mapRange(PPB_BASE, PPB_SIZE))
+        return false;
+    for (i = 0; i < REGION_COUNT; i++)
+    {
+        regions[i].values = calloc(regions[i].size >> 2, sizeof(uint32_t));
+        regions[i].reads = calloc(regions[i].size >> 2, sizeof(uint32_t));
+        regions[i].writes = calloc(regions[i].size >> 2, sizeof(uint32_t));
+        if (!regions[i].values || !regions[i].reads || !regions[i].writes)
+            return false;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    action.sa_sigaction = faultHandler;
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = trapHandler;
+    sigaction(SIGTRAP, &action, NULL);
+
+    installDefaultHooks();
+    initialized = true;
+    return true;
+}
+
+// Zeroes every register and count and restores the default hooks
+void resetRegEmu(void)
+{
+    uint8_t i;
+    for (i = 0; i < REGION_COUNT; i++)
+        memset(regions[i].values, 0, (regions[i].size >> 2) * sizeof(uint32_t));
+    clearRegEmuCounts();
+    installDefaultHooks();
+}
+
+// Replaces the hooks of a register, NULL for both removes them
+void setRegEmuHooks(uint32_t address, REG_READ_HOOK readHook, REG_WRITE_HOOK writeHook)
+{
+    HOOK* hook = findHook(address & ~3u);
+    if (!hook)
+    {
+        if (hookCount == MAX_HOOKS)
+            fail("too many register hooks");
+        hook = &hooks[hookCount++];
+        hook->address = address & ~3u;
+    }
+    hook->readHook = readHook;
+    hook->writeHook = writeHook;
+}
+
+// Test side access, not counted and no hooks
+uint32_t peekRegEmu(uint32_t address)
+{
+    REGION* region = findRegion(address);
+    return region ? region->values[(address - region->base) >> 2] : 0;
+}
+
+void pokeRegEmu(uint32_t address, uint32_t value)
+{
+    REGION* region = findRegion(address);
+    if (region)
+        region->values[(address - region->base) >> 2] = value;
+}
+
+uint32_t getRegEmuReads(uint32_t address)
+{
+    REGION* region = findRegion(address);
+    return region ? region->reads[(address - region->base) >> 2] : 0;
+}
+
+uint32_t getRegEmuWrites(uint32_t address)
+{
+    REGION* region = findRegion(address);
+    return region ? region->writes[(address - region->base) >> 2] : 0;
+}
+
+uint32_t getRegEmuTotalReads(void)
+{
+    return totalReads;
+}
+
+uint32_t getRegEmuTotalWrites(void)
+{
+    return totalWrites;
+}
+
+void clearRegEmuCounts(void)
+{
+    uint8_t i;
+    for (i = 0; i < REGION_COUNT; i++)
+    {
+        memset(regions[i].reads, 0, (regions[i].size >> 2) * sizeof(uint32_t));
+        memset(regions[i].writes, 0, (regions[i].size >> 2) * sizeof(uint32_t));
+    }
+    totalReads = totalWrites = 0;
+}
+
+// One line per register touched since the counts were cleared
+void printRegEmuCounts(void)
+{
+    uint32_t i, n;
+    uint8_t r;
+    for (r = 0; r < REGION_COUNT; r++)
+        for (n = 0; n < regions[r].size >> 2; n++)
+            if (regions[r].reads[n] || regions[r].writes[n])
+            {
+                i = regions[r].base + (n << 2);
+                printf("0x%08X  reads %8u  writes %8u  value 0x%08X\n", i,
+                       regions[r].reads[n], regions[r].writes[n], regions[r].values[n]);
+            }
+    printf("total       reads %8u  writes %8u\n", totalReads, totalWrites);
+}
+
+// Compares the counts since the last clear with the expected traffic of one
+// call, prints a line per entry and clears the counts; returns true on a match
+bool checkRegEmuCounts(const char* call, const REG_EMU_EXPECTED expected[], uint8_t count, bool verbose)
+{
+    uint32_t reads, writes;
+    uint8_t i;
+    bool ok = true;
+
+    printf("%s\n", call);
+    if (verbose)
+        printRegEmuCounts();
+    for (i = 0; i < count; i++)
+    {
+        reads = expected[i].address ? getRegEmuReads(expected[i].address) : totalReads;
+        writes = expected[i].address ? getRegEmuWrites(expected[i].address) : totalWrites;
+        if (reads != expected[i].reads || writes != expected[i].writes)
+        {
+            printf("  FAIL %-12s reads %u writes %u, expected %u and %u\n", expected[i].name,
+                   reads, writes, expected[i].reads, expected[i].writes);
+            ok = false;
+        }
+        else
+            printf("  pass %-12s reads %u writes %u\n", expected[i].name, reads, writes);
+    }
+    clearRegEmuCounts();
+    return ok;
+}
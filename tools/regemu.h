@@ -0,0 +1,89 @@
+// TM4C123 Register Emulator
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Host:            Linux on x86-64, GCC
+// Lets the drivers run unmodified on a PC. The peripheral, bit-band alias and
+// private peripheral bus ranges are mapped at their TM4C123 addresses with no
+// access rights, so every register access in a driver faults into the
+// emulator, which serves it from a simulated register file, runs any hooks
+// installed for that register and counts it.
+//
+// Build a host program from a project directory, for example SPI/:
+//   gcc -O2 -std=gnu99 -no-pie -Wl,-Tdata=0x20000000 -include ../tools/regemu.h
+//       -I. -o spi_host spi_host.c gpio.c spi.c udma.c nvic.c wait.c ../tools/regemu.c
+// -Tdata places the host variables at the TM4C123 SRAM address, which the
+// SRAM bit-band alias (0x22000000) needs; it can be left out when no driver
+// bit-bands its own variables. tools/regemu_spi.c and tools/regemu_wd0.c are
+// the register traffic tests and tools/regemu_swi2c.c models an I2C bus in
+// hooks, each with its build line.
+// Force including this header turns the CCS intrinsics into no-ops, so the
+// inline assembly in nvic.c and wait.c compiles away (BASEPRI reads as 0 and
+// waits return at once). Files that depend on LDREX/STREX (uart0.c) or on the
+// startup vectors are not meant for the host build.
+//
+// Notes:
+//   Registers start at 0, reset values that matter to a test are set with
+//     pokeRegEmu() after initRegEmu()
+//   A read hook returns the value the driver sees, a write hook returns the
+//     value stored, so W1C and read-only bits are modelled in the hook
+//   Hooks run in signal context and must use peekRegEmu()/pokeRegEmu(), a
+//     direct register access from a hook is fatal
+//   A read-modify-write instruction (e.g. ORL to memory) counts as one write
+//     and does not call the read hook
+//   Interrupts are not simulated, call the ISR from the test when a hook
+//     raises the condition
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#ifndef REGEMU_H_
+#define REGEMU_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// CCS intrinsics used by the drivers
+#ifndef _delay_cycles
+#define _delay_cycles(x)        ((void)(x))
+#endif
+#define __asm(x)                ((void)0)
+
+// DWT_CYCCNT advances by this much on every read unless hooked, so cycle
+// deadlines in the drivers expire on the host
+#define REGEMU_CYCCNT_STEP      16
+
+typedef uint32_t (*REG_READ_HOOK)(uint32_t address, uint32_t value);
+typedef uint32_t (*REG_WRITE_HOOK)(uint32_t address, uint32_t old, uint32_t value);
+
+// Expected traffic of one API call, address 0 stands for the totals
+typedef struct _REG_EMU_EXPECTED
+{
+    const char* name;
+    uint32_t address;
+    uint32_t reads;
+    uint32_t writes;
+} REG_EMU_EXPECTED;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+bool initRegEmu(void);
+void resetRegEmu(void);
+void setRegEmuHooks(uint32_t address, REG_READ_HOOK readHook, REG_WRITE_HOOK writeHook);
+uint32_t peekRegEmu(uint32_t address);
+void pokeRegEmu(uint32_t address, uint32_t value);
+uint32_t getRegEmuReads(uint32_t address);
+uint32_t getRegEmuWrites(uint32_t address);
+uint32_t getRegEmuTotalReads(void);
+uint32_t getRegEmuTotalWrites(void);
+void clearRegEmuCounts(void);
+void printRegEmuCounts(void);
+bool checkRegEmuCounts(const char* call, const REG_EMU_EXPECTED expected[], uint8_t count, bool verbose);
+
+#endif
@@ -0,0 +1,129 @@
+// SPI Register Traffic Test
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Builds on x86-64 Linux from the SPI project directory:
+//   gcc -O2 -std=gnu99 -no-pie -Wl,-Tdata=0x20000000 -include ../tools/regemu.h
+//       -I. -o regemu_spi ../tools/regemu_spi.c gpio.c spi.c udma.c nvic.c wait.c ../tools/regemu.c
+// Usage:
+//   regemu_spi [-v]
+// Runs the SPI driver against the register emulator and compares the register
+// reads and writes of each API call with the expected counts, so a change
+// that adds register traffic to a hot path shows up as a failure. -v prints
+// every register touched. Exits with 0 on success, 1 on any mismatch.
+// The counts are for GCC at -O2: a read-modify-write the compiler folds into
+// one instruction counts as a write only, so other levels can differ.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "spi.h"
+#include "regemu.h"
+
+#define SYSTEM_CLK          40000000
+#define SPI_BAUD            2000000
+
+#define REG(r)              ((uint32_t)(uintptr_t)&(r))
+#define COUNT(a)            (sizeof(a) / sizeof(a[0]))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static bool verbose;
+static bool ok = true;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void check(const char* call, const REG_EMU_EXPECTED expected[], uint8_t count)
+{
+    ok = checkRegEmuCounts(call, expected, count, verbose) && ok;
+}
+
+static void checkValue(const char* name, uint32_t address, uint32_t mask, uint32_t value)
+{
+    uint32_t actual = peekRegEmu(address) & mask;
+    if (actual != value)
+    {
+        printf("  FAIL %-12s 0x%08X, expected 0x%08X\n", name, actual, value);
+        ok = false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const uint8_t tx[3] = {0x40, 0x0A, 0x28};
+    uint8_t rx[3];
+
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    if (!initRegEmu())
+    {
+        printf("register map in use\n");
+        return 1;
+    }
+
+    initSpi(SPI1, USE_SSI_RX | USE_SSI_FSS);
+    setSpiBaudRate(SPI1, SPI_BAUD, SYSTEM_CLK);
+    setSpiMode(SPI1, 1, 1);
+    {
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",     0,                17, 42},
+            {"SSI1 CR1",  REG(SSI1_CR1_R),   5,  6},
+            {"SSI1 CPSR", REG(SSI1_CPSR_R),  0,  1},
+        };
+        check("initSpi + setSpiBaudRate + setSpiMode", expected, COUNT(expected));
+    }
+    checkValue("SSI1 CR0", REG(SSI1_CR0_R), SSI_CR0_SPH | SSI_CR0_SPO | SSI_CR0_DSS_M,
+               SSI_CR0_SPH | SSI_CR0_SPO | SSI_CR0_DSS_8);
+
+    // Three bytes fit the FIFO with SPH=1, so the hardware FSS frames them
+    transferSpiFrame(SPI1, tx, rx, 3);
+    {
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",     0,                 6,  4},
+            {"SSI1 DR",   REG(SSI1_DR_R),    3,  3},
+            {"SSI1 SR",   REG(SSI1_SR_R),    2,  0},
+        };
+        check("transferSpiFrame 3 bytes", expected, COUNT(expected));
+    }
+
+    // A frame longer than the FIFO falls back to the GPIO chip select
+    {
+        uint8_t longTx[SSI_FIFO_DEPTH + 1] = {0};
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",     0,                21, 16},
+            {"SSI1 DR",   REG(SSI1_DR_R),    9,  9},
+            {"SSI1 SR",   REG(SSI1_SR_R),   10,  0},
+        };
+        transferSpiFrame(SPI1, longTx, 0, sizeof(longTx));
+        check("transferSpiFrame 9 bytes", expected, COUNT(expected));
+    }
+
+    writeSpiData(SPI1, 0x55);
+    {
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",     0,                 1,  1},
+        };
+        check("writeSpiData", expected, COUNT(expected));
+    }
+
+    printf("%s\n", ok ? "pass" : "FAIL");
+    return ok ? 0 : 1;
+}
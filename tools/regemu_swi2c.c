@@ -0,0 +1,406 @@
+// Software I2C Bus Test
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Builds on x86-64 Linux from the I2C project directory:
+//   gcc -O2 -std=gnu99 -no-pie -Wl,-Tdata=0x20000000 -include ../tools/regemu.h
+//       -I. -o regemu_swi2c ../tools/regemu_swi2c.c swi2c.c gpio.c ../tools/regemu.c
+// Usage:
+//   regemu_swi2c [-v]
+// Runs the software I2C master against an open-drain bus modelled in
+// register hooks. SCL and SDA are the wired AND of the master (its GPIO DIR
+// bits), a register file slave at SLAVE_ADD and a second master that
+// can contend for the bus. The slave follows START, STOP and every SCL edge,
+// ACKs its address and the bytes it accepts, stretches SCL when asked and
+// shifts its registers out on reads. Covers writes and reads with ACK,
+// address and data NACK, clock stretching, the clock-low timeout and
+// arbitration loss. -v prints the bus events. Exits with 0 on success, 1 on
+// any mismatch.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "i2c.h"
+#include "swi2c.h"
+#include "dwt.h"
+#include "regemu.h"
+
+#define SYSTEM_CLK          40000000
+#define BIT_RATE            100000
+
+#define BUS                 SW_I2C0
+#define SCL_PIN             2               // PB2
+#define SDA_PIN             3               // PB3
+#define SCL_MASK            (1 << SCL_PIN)
+#define SDA_MASK            (1 << SDA_PIN)
+
+#define SLAVE_ADD           0x50
+#define OTHER_ADD           0x48            // wins arbitration against 0x50 on the third bit
+#define SLAVE_REGISTERS     256
+#define STRETCH_FOREVER     0xFFFFFFFF
+#define FAST_CYCCNT_STEP    4096            // reaches the 25 ms clock-low limit in few reads
+
+#define REG(r)              ((uint32_t)(uintptr_t)&(r))
+
+typedef enum _SLAVE_STATE
+{
+    SLAVE_IDLE,                             // waiting for START
+    SLAVE_ADDRESS,
+    SLAVE_WRITE,                            // master to slave bytes
+    SLAVE_READ                              // slave to master bytes
+} SLAVE_STATE;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static bool verbose;
+static bool ok = true;
+
+// Wire state, the master side is read from GPIO_PORTB_DIR_R
+static bool slaveSclLow;
+static bool slaveSdaLow;
+static bool otherSdaLow;
+static bool scl = true;
+static bool sda = true;
+
+// Register file slave
+static SLAVE_STATE state;
+static int8_t bit;                          // -1 until the SCL fall that ends START
+static uint8_t shift;
+static bool reading;                        // address byte had r/~w=1
+static bool pointerSet;
+static bool masterAck;
+static uint8_t pointer;
+static uint8_t registers[SLAVE_REGISTERS];
+static uint8_t accepted;                    // bytes ACKed in the current write
+static uint8_t acceptLimit;                 // bytes ACKed before a data NACK
+static uint32_t stretchReads;               // DATA reads SCL is held low on every rise
+static uint32_t stretchLeft;
+static uint32_t stretches;
+static uint32_t starts;
+static uint32_t stops;
+static uint32_t cycleStep = REGEMU_CYCCNT_STEP;
+
+// Second master, drives its address in step with the bus while enabled
+static bool otherActive;
+static bool otherLost;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void trace(const char* event)
+{
+    if (verbose)
+        printf("    %s\n", event);
+}
+
+// Drives bit n of the other master's address byte, it stops at the first
+// bit it loses and after the last address bit
+static void driveOther(void)
+{
+    if (!otherActive || state != SLAVE_ADDRESS || bit < 0 || bit > 7)
+        otherSdaLow = false;
+    else
+        otherSdaLow = !(((OTHER_ADD << 1) >> (7 - bit)) & 1);
+}
+
+static void driveReadBit(void)
+{
+    slaveSdaLow = !((shift >> (7 - bit)) & 1);
+}
+
+static void loadReadByte(void)
+{
+    shift = registers[pointer++];
+    driveReadBit();
+}
+
+static void risingScl(void)
+{
+    if (bit < 0 || bit > 8)
+        return;
+    if (bit < 8 && (state == SLAVE_ADDRESS || state == SLAVE_WRITE))
+        shift = (shift << 1) | sda;
+    if (bit < 8 && otherActive && state == SLAVE_ADDRESS && !otherSdaLow && !sda)
+        otherLost = true;
+    if (bit == 8 && state == SLAVE_READ)
+        masterAck = !sda;
+}
+
+static void fallingScl(void)
+{
+    if (state == SLAVE_IDLE)
+        return;
+    if (bit < 0)
+    {
+        bit = 0;
+        driveOther();
+        return;
+    }
+    if (bit < 8)
+    {
+        bit++;
+        if (bit < 8)
+        {
+            if (state == SLAVE_READ)
+                driveReadBit();
+            driveOther();
+            return;
+        }
+        // Byte done, drive the ACK slot
+        otherSdaLow = false;
+        if (state == SLAVE_ADDRESS)
+        {
+            if ((shift >> 1) != SLAVE_ADD)
+            {
+                trace("address NACK");
+                state = SLAVE_IDLE;
+                return;
+            }
+            reading = shift & 1;
+            slaveSdaLow = true;
+        }
+        else if (state == SLAVE_WRITE)
+        {
+            if (accepted >= acceptLimit)
+            {
+                trace("data NACK");
+                return;
+            }
+            if (!pointerSet)
+                pointer = shift;
+            else
+                registers[pointer++] = shift;
+            pointerSet = true;
+            accepted++;
+            slaveSdaLow = true;
+        }
+        else
+            slaveSdaLow = false;            // master drives the ACK of a read byte
+        return;
+    }
+
+    // ACK slot done
+    bit = 0;
+    slaveSdaLow = false;
+    if (state == SLAVE_ADDRESS)
+    {
+        state = reading ? SLAVE_READ : SLAVE_WRITE;
+        shift = 0;
+        if (reading)
+            loadReadByte();
+    }
+    else if (state == SLAVE_READ)
+    {
+        if (masterAck)
+            loadReadByte();
+        else
+            state = SLAVE_IDLE;             // NACK ends the read, wait for STOP
+    }
+    else
+        shift = 0;
+}
+
+// Recomputes the wired AND and feeds every change of SCL and SDA to the slave
+static void updateBus(void)
+{
+    uint32_t dir = peekRegEmu(REG(GPIO_PORTB_DIR_R));
+    uint8_t settle;
+
+    // A slave reaction can change SDA again, so loop until the lines are stable
+    for (settle = 0; settle < 4; settle++)
+    {
+        bool newScl = !(dir & SCL_MASK) && !slaveSclLow;
+        bool newSda = !(dir & SDA_MASK) && !slaveSdaLow && !otherSdaLow;
+        bool oldScl = scl, oldSda = sda;
+
+        if (newScl == oldScl && newSda == oldSda)
+            return;
+        scl = newScl;
+        sda = newSda;
+        if (oldScl && scl && oldSda && !sda)
+        {
+            trace("START");
+            starts++;
+            state = SLAVE_ADDRESS;
+            bit = -1;
+            shift = 0;
+            pointerSet = false;
+            accepted = 0;
+            slaveSdaLow = false;
+            driveOther();
+        }
+        else if (oldScl && scl && !oldSda && sda)
+        {
+            trace("STOP");
+            stops++;
+            state = SLAVE_IDLE;
+            slaveSdaLow = false;
+            otherSdaLow = false;
+        }
+        else if (!oldScl && scl)
+            risingScl();
+        else if (oldScl && !scl)
+            fallingScl();
+    }
+}
+
+// The master releases or drives a line
+static uint32_t dirWrite(uint32_t address, uint32_t old, uint32_t value)
+{
+    pokeRegEmu(address, value);
+    if ((old & SCL_MASK) && !(value & SCL_MASK) && stretchReads)
+    {
+        slaveSclLow = true;
+        stretchLeft = stretchReads;
+        stretches++;
+    }
+    updateBus();
+    return value;
+}
+
+// The master samples the lines, a stretched SCL is let go after stretchReads
+static uint32_t dataRead(uint32_t address, uint32_t value)
+{
+    if (slaveSclLow && stretchLeft != STRETCH_FOREVER && --stretchLeft == 0)
+    {
+        slaveSclLow = false;
+        updateBus();
+    }
+    value &= ~(SCL_MASK | SDA_MASK);
+    return value | (scl ? SCL_MASK : 0) | (sda ? SDA_MASK : 0);
+}
+
+// Cycle counter with a step the clock-low timeout case can raise
+static uint32_t cycleCounterRead(uint32_t address, uint32_t value)
+{
+    value += cycleStep;
+    pokeRegEmu(address, value);
+    return value;
+}
+
+// Idle bus and slave before each case
+static void resetBus(void)
+{
+    pokeRegEmu(REG(GPIO_PORTB_DIR_R), peekRegEmu(REG(GPIO_PORTB_DIR_R)) & ~(SCL_MASK | SDA_MASK));
+    slaveSclLow = slaveSdaLow = otherSdaLow = false;
+    scl = sda = true;
+    state = SLAVE_IDLE;
+    acceptLimit = 0xFF;
+    stretchReads = 0;
+    stretches = starts = stops = 0;
+    otherActive = otherLost = false;
+}
+
+static void checkStatus(const char* name, uint8_t status, uint8_t expected)
+{
+    if (status != expected)
+    {
+        printf("  FAIL %-24s status %u, expected %u\n", name, status, expected);
+        ok = false;
+    }
+    else
+        printf("  pass %-24s status %u\n", name, status);
+}
+
+static void checkTrue(const char* name, bool value)
+{
+    if (!value)
+    {
+        printf("  FAIL %s\n", name);
+        ok = false;
+    }
+}
+
+static bool isBusIdle(void)
+{
+    return scl && sda && state == SLAVE_IDLE;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const uint8_t tx[3] = {0x11, 0x22, 0x33};
+    uint8_t rx[3];
+    uint8_t status;
+
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    if (!initRegEmu())
+    {
+        printf("register map in use\n");
+        return 1;
+    }
+    setRegEmuHooks(REG(GPIO_PORTB_DIR_R), NULL, dirWrite);
+    setRegEmuHooks(REG(GPIO_PORTB_DATA_R), dataRead, NULL);
+    setRegEmuHooks(REG(DWT_CYCCNT_R), cycleCounterRead, NULL);
+    resetBus();
+    initSwI2c(BUS, PORTB, SCL_PIN, PORTB, SDA_PIN, BIT_RATE, SYSTEM_CLK);
+
+    // ACK: register write, then a read back through a repeated START
+    resetBus();
+    status = writeSwI2cRegisters(BUS, SLAVE_ADD, 0x10, tx, sizeof(tx));
+    checkStatus("write ACK", status, I2C_OK);
+    checkTrue("write reaches the registers", memcmp(&registers[0x10], tx, sizeof(tx)) == 0);
+    checkTrue("write ends with STOP", isBusIdle() && starts == 1 && stops == 1);
+
+    resetBus();
+    memset(rx, 0, sizeof(rx));
+    status = readSwI2cRegisters(BUS, SLAVE_ADD, 0x10, rx, sizeof(rx));
+    checkStatus("read ACK", status, I2C_OK);
+    checkTrue("read returns the registers", memcmp(rx, tx, sizeof(rx)) == 0);
+    checkTrue("read uses a repeated START", isBusIdle() && starts == 2 && stops == 1);
+
+    // NACK: no device at the address, then a device that refuses a data byte
+    resetBus();
+    checkTrue("poll absent address", !pollSwI2cAddress(BUS, SLAVE_ADD + 1));
+    checkStatus("address NACK", getSwI2cStatus(BUS), I2C_NACK_ADDRESS);
+    checkTrue("address NACK ends with STOP", isBusIdle() && stops == 1);
+
+    resetBus();
+    acceptLimit = 2;                        // register and one data byte
+    registers[0x20] = registers[0x21] = 0;
+    status = writeSwI2cRegisters(BUS, SLAVE_ADD, 0x20, tx, sizeof(tx));
+    checkStatus("data NACK", status, I2C_NACK_DATA);
+    checkTrue("data NACK stops after the refused byte", registers[0x20] == tx[0] && registers[0x21] == 0);
+    checkTrue("data NACK ends with STOP", isBusIdle() && stops == 1);
+
+    // Clock stretching: every SCL rise is held low for a while
+    resetBus();
+    stretchReads = 20;
+    memset(rx, 0, sizeof(rx));
+    status = readSwI2cRegisters(BUS, SLAVE_ADD, 0x10, rx, sizeof(rx));
+    checkStatus("stretched read", status, I2C_OK);
+    checkTrue("stretched read returns the registers", memcmp(rx, tx, sizeof(rx)) == 0);
+    checkTrue("stretched read was stretched", stretches > 0);
+
+    resetBus();
+    stretchReads = STRETCH_FOREVER;
+    cycleStep = FAST_CYCCNT_STEP;
+    status = writeSwI2cRegister(BUS, SLAVE_ADD, 0x30, 0x44);
+    cycleStep = REGEMU_CYCCNT_STEP;
+    checkStatus("clock held low", status, I2C_CLOCK_TIMEOUT);
+
+    // Arbitration: a second master addresses 0x48 at the same time and wins
+    resetBus();
+    otherActive = true;
+    status = writeSwI2cRegister(BUS, SLAVE_ADD, 0x30, 0x44);
+    checkStatus("arbitration lost", status, I2C_ARB_LOST);
+    checkTrue("loser releases SCL and SDA", !(peekRegEmu(REG(GPIO_PORTB_DIR_R)) & (SCL_MASK | SDA_MASK)));
+    checkTrue("winner keeps its address", !otherLost);
+    checkTrue("loser does not STOP", stops == 0);
+
+    printf("%s\n", ok ? "pass" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Watchdog Supervisor Register Traffic Test
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Builds on x86-64 Linux from the RTC project directory:
+//   gcc -O2 -std=gnu99 -no-pie -Wl,-Tdata=0x20000000 -include ../tools/regemu.h
+//       -I. -o regemu_wd0 ../tools/regemu_wd0.c wd0.c crash.c nvic.c ../tools/regemu.c
+// Usage:
+//   regemu_wd0 [-v]
+// Runs the watchdog supervisor against the register emulator. Check-ins are
+// SRAM bit-band stores, so this also covers the SRAM alias, which needs the
+// -Tdata placement. Checks the feed and miss decisions of the first-timeout
+// interrupt and the register traffic of each call. Exits with 0 on success,
+// 1 on any mismatch.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "wd0.h"
+#include "regemu.h"
+
+#define SYSTEM_CLK          40000000
+#define TIMEOUT_US          1000000
+
+#define REG(r)              ((uint32_t)(uintptr_t)&(r))
+#define COUNT(a)            (sizeof(a) / sizeof(a[0]))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static bool verbose;
+static bool ok = true;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void check(const char* call, const REG_EMU_EXPECTED expected[], uint8_t count)
+{
+    ok = checkRegEmuCounts(call, expected, count, verbose) && ok;
+}
+
+static void checkMissed(uint32_t expected)
+{
+    if (getWatchdog0MissedTasks() != expected)
+    {
+        printf("  FAIL missed tasks 0x%X, expected 0x%X\n", getWatchdog0MissedTasks(), expected);
+        ok = false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    uint32_t frame[8] = {0};
+    uint8_t fast, slow;
+
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    if (!initRegEmu())
+    {
+        printf("register map in use\n");
+        return 1;
+    }
+
+    initWatchdog0(TIMEOUT_US, SYSTEM_CLK);
+    clearRegEmuCounts();
+    fast = registerWatchdog0Task(TIMEOUT_US);
+    slow = registerWatchdog0Task(2 * TIMEOUT_US);
+    checkInWatchdog0Task(fast);
+    {
+        // Check-ins touch SRAM only
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",        0,                        0, 0},
+        };
+        check("registerWatchdog0Task x2 + checkInWatchdog0Task", expected, COUNT(expected));
+    }
+
+    // Both tasks within their deadline: fed
+    watchdog0Isr(frame);
+    {
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",        0,                        0, 1},
+            {"WDT0 ICR",     REG(WATCHDOG0_ICR_R),     0, 1},
+        };
+        check("watchdog0Isr, all checked in", expected, COUNT(expected));
+    }
+    checkMissed(0);
+
+    // No check-ins for a second period: both deadlines pass, the hang is
+    // captured and the watchdog is left to reset the device
+    watchdog0Isr(frame);
+    {
+        const REG_EMU_EXPECTED expected[] =
+        {
+            {"total",        0,                        4, 1},
+            {"WDT0 ICR",     REG(WATCHDOG0_ICR_R),     0, 0},
+            {"NVIC DIS0",    REG(NVIC_DIS0_R),         0, 1},
+        };
+        check("watchdog0Isr, both missed", expected, COUNT(expected));
+    }
+    checkMissed((1u << fast) | (1u << slow));
+
+    printf("%s\n", ok ? "pass" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+// Ring Buffer Stress Test
+// Prithvi Bhat
+
+//-----------------------------------------------------------------------------
+// Host Target
+//-----------------------------------------------------------------------------
+
+// Builds on Linux with any C99 compiler and pthreads:
+//   gcc -O2 -pthread -o ring_stress ring_stress.c
+// Usage:
+//   ring_stress [iterations]
+// Runs a producer thread against a consumer thread on common/ring.h, once for
+// the byte ring and once for the record ring, mixing single and batch calls
+// with random sizes so the indices wrap many times. Every value carries a
+// sequence number; the consumer checks that nothing is lost, duplicated,
+// reordered or torn. Exits with 0 on success, 1 on the first mismatch.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include "../common/ring.h"
+
+#define DEFAULT_ITERATIONS  2000000
+#define BYTE_RING_SIZE      64
+#define RECORD_RING_COUNT   16
+#define BATCH_MAX           24
+
+typedef struct _RECORD
+{
+    uint32_t sequence;
+    uint32_t check;                         // ~sequence, catches torn records
+    uint8_t pad[8];
+} RECORD;
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t iterations = DEFAULT_ITERATIONS;
+static RING_BUFFER byteRing;
+static uint8_t byteStorage[BYTE_RING_SIZE];
+static RECORD_RING recordRing;
+static RECORD recordStorage[RECORD_RING_COUNT];
+static volatile bool failed;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// xorshift, one state per thread
+static uint32_t nextRandom(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void* produceBytes(void* arg)
+{
+    uint32_t seed = 0x1234567;
+    uint32_t sent = 0;
+    uint8_t batch[BATCH_MAX];
+    uint32_t i, n;
+    (void)arg;
+
+    while (sent < iterations && !failed)
+    {
+        if (nextRandom(&seed) & 1)
+        {
+            if (pushRing(&byteRing, (uint8_t)sent))
+                sent++;
+            else
+                sched_yield();              // full, let the consumer run on a single core
+            continue;
+        }
+        n = nextRandom(&seed) % BATCH_MAX + 1;
+        if (n > iterations - sent)
+            n = iterations - sent;
+        for (i = 0; i < n; i++)
+            batch[i] = (uint8_t)(sent + i);
+        n = pushRingBatch(&byteRing, batch, n);
+        if (n == 0)
+            sched_yield();
+        sent += n;
+    }
+    return NULL;
+}
+
+static bool consumeBytes(void)
+{
+    uint32_t seed = 0x7654321;
+    uint32_t received = 0;
+    uint8_t batch[BATCH_MAX];
+    uint32_t i, n;
+    uint8_t value;
+
+    while (received < iterations)
+    {
+        if (nextRandom(&seed) & 1)
+        {
+            if (!popRing(&byteRing, &value))
+            {
+                sched_yield();              // empty, let the producer run on a single core
+                continue;
+            }
+            batch[0] = value;
+            n = 1;
+        }
+        else
+        {
+            n = popRingBatch(&byteRing, batch, nextRandom(&seed) % BATCH_MAX + 1);
+            if (n == 0)
+                sched_yield();
+        }
+        for (i = 0; i < n; i++, received++)
+            if (batch[i] != (uint8_t)received)
+            {
+                printf("byte ring: expected %u got %u at %u\n", (uint8_t)received, batch[i], received);
+                return false;
+            }
+    }
+    return getRingCount(&byteRing) == 0;
+}
+
+static void* produceRecords(void* arg)
+{
+    uint32_t seed = 0x2468ace;
+    uint32_t sent = 0;
+    RECORD batch[BATCH_MAX];
+    uint32_t i, n;
+    (void)arg;
+
+    while (sent < iterations && !failed)
+    {
+        n = nextRandom(&seed) % BATCH_MAX + 1;
+        if (n > iterations - sent)
+            n = iterations - sent;
+        for (i = 0; i < n; i++)
+        {
+            batch[i].sequence = sent + i;
+            batch[i].check = ~(sent + i);
+        }
+        if (n == 1)
+            n = pushRecordRing(&recordRing, &batch[0]);
+        else
+            n = pushRecordRingBatch(&recordRing, batch, n);
+        if (n == 0)
+            sched_yield();
+        sent += n;
+    }
+    return NULL;
+}
+
+static bool consumeRecords(void)
+{
+    uint32_t seed = 0x13579bd;
+    uint32_t received = 0;
+    RECORD batch[BATCH_MAX];
+    uint32_t i, n;
+
+    while (received < iterations)
+    {
+        n = nextRandom(&seed) % BATCH_MAX + 1;
+        if (n == 1)
+            n = popRecordRing(&recordRing, &batch[0]);
+        else
+            n = popRecordRingBatch(&recordRing, batch, n);
+        if (n == 0)
+            sched_yield();
+        for (i = 0; i < n; i++, received++)
+            if (batch[i].sequence != received || batch[i].check != ~received)
+            {
+                printf("record ring: expected %u got %u/%08x\n", received, batch[i].sequence, batch[i].check);
+                return false;
+            }
+    }
+    return getRecordRingCount(&recordRing) == 0;
+}
+
+static bool runTest(const char* name, void* (*producer)(void*), bool (*consumer)(void))
+{
+    pthread_t thread;
+    bool ok;
+
+    failed = false;
+    pthread_create(&thread, NULL, producer, NULL);
+    ok = consumer();
+    failed = !ok;
+    pthread_join(thread, NULL);
+    printf("%-12s %s (%u values)\n", name, ok ? "pass" : "FAIL", iterations);
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+// Main
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    bool ok;
+
+    if (argc > 1)
+        iterations = strtoul(argv[1], NULL, 0);
+    initRing(&byteRing, byteStorage, BYTE_RING_SIZE);
+    initRecordRing(&recordRing, recordStorage, RECORD_RING_COUNT, sizeof(RECORD));
+
+    ok = runTest("byte ring", produceBytes, consumeBytes);
+    ok = runTest("record ring", produceRecords, consumeRecords) && ok;
+    return ok ? 0 : 1;
+}